@@ -0,0 +1,164 @@
+// Benchmark suite for the engine's hot paths
+//
+// Run from the assets directory (the map and textures are loaded relative to it):
+//      cmake --build . --target run_bench              (writes bench.json into the build directory)
+//      <build dir>/SpeedJam5_bench [--out results.json] [--filter name]
+//
+// Results are JSON on stdout (or --out), a readable summary goes to stderr. Everything is seeded,
+// so two runs of the same build do the same work and their results can be diffed.
+
+#include "Bench.hpp"
+
+BenchSuite::BenchSuite(const std::string &filter)
+{
+    this->filter = filter;
+}
+
+bool BenchSuite::wants(const std::string &name) const
+{
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchSuite::addResult(const std::string &name, const std::string &params, std::vector<double> &samples)
+{
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    result.iterations = samples.size();
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0;
+    for (double s : samples)
+        sum += s;
+
+    result.mean_us = sum / samples.size();
+    result.min_us = samples.front();
+    result.median_us = samples[samples.size() / 2];
+    result.max_us = samples.back();
+
+    fprintf(stderr, "%-28s %-24s %12.3f us (min %.3f, median %.3f, max %.3f, n=%d)\n",
+            name.c_str(), params.c_str(), result.mean_us, result.min_us, result.median_us, result.max_us, result.iterations);
+
+    results.push_back(result);
+}
+
+void BenchSuite::record(const std::string &name, const std::string &params, std::vector<double> &samples_us)
+{
+    if (!wants(name) || samples_us.empty())
+        return;
+
+    addResult(name, params, samples_us);
+}
+
+void BenchSuite::writeJson(FILE *file) const
+{
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"params\": \"%s\", \"iterations\": %d, \"mean_us\": %.3f, \"min_us\": %.3f, \"median_us\": %.3f, \"max_us\": %.3f}%s\n",
+                r.name.c_str(), r.params.c_str(), r.iterations, r.mean_us, r.min_us, r.median_us, r.max_us, i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
+
+// ==================================================
+// Query iteration: filter built per frame vs cached query
+// ==================================================
+void benchQueries(BenchSuite &suite)
+{
+    const int entity_count = 10000;
+    flecs::world world;
+
+    // Mix of solid bodies, cooking zones and plain positioned entities, like a big kitchen
+    for (int i = 0; i < entity_count; i++)
+    {
+        flecs::entity e = world.entity();
+        e.set<plt::Position>({(float)(i % 640), (float)(i / 640), 0});
+        e.set<plt::Collider>({Rectangle{0, 0, 32, 32}, c2AABB{0, 0, 0, 0}});
+
+        if (i % 4 == 0)
+            e.set<plt::SolidBody>({1});
+        if (i % 100 == 0)
+            e.set<plt::CookingZone>({plt::CookingZone_Bag, Rectangle{0, 0, 32, 32}});
+    }
+
+    float sink = 0;
+    std::string params = "entities=" + std::to_string(entity_count);
+
+    suite.run("query_filter_per_frame", params, 1000, [&]()
+              {
+                  flecs::filter<plt::Position, plt::Collider> f = world.filter<plt::Position, plt::Collider>();
+                  f.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll)
+                         {
+                             sink += pos.x + coll.bounds.width; //
+                         });
+              });
+
+    flecs::query<plt::Position, plt::Collider> q = world.query<plt::Position, plt::Collider>();
+
+    suite.run("query_cached", params, 1000, [&]()
+              {
+                  q.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll)
+                         {
+                             sink += pos.x + coll.bounds.width; //
+                         });
+              });
+
+    // Keep the loops from being optimized away
+    if (sink == 0.123f)
+        fprintf(stderr, "%f\n", sink);
+}
+
+int main(int argc, char **argv)
+{
+    // Command line
+    //      --out <file>        Write the JSON results to file instead of stdout
+    //      --filter <name>     Only run benchmarks whose name contains name
+    const char *out_path = nullptr;
+    std::string filter;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+    }
+
+    // A hidden window gives the map bake a GL context. Without a display the GPU benchmarks are skipped
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "SpeedJam5_bench");
+    bool has_window = IsWindowReady();
+
+    if (!has_window)
+        fprintf(stderr, "No window available, skipping GPU benchmarks\n");
+
+    BenchSuite suite(filter);
+
+    benchQueries(suite);
+    benchGame(suite, has_window);
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "Can't open %s\n", out_path);
+        return 1;
+    }
+
+    suite.writeJson(out);
+
+    if (out != stdout)
+        fclose(out);
+
+    if (has_window)
+        CloseWindow();
+
+    return 0;
+}
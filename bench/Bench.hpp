@@ -0,0 +1,69 @@
+#pragma once
+#include "main.hpp"
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Timing summary of one benchmark, every figure is microseconds per iteration
+struct BenchResult
+{
+    std::string name;
+
+    // Free-form parameters of the run ("colliders=1000"), kept in the JSON for comparing like with like
+    std::string params;
+
+    int iterations;
+    double mean_us;
+    double min_us;
+    double median_us;
+    double max_us;
+};
+
+class BenchSuite
+{
+private:
+    std::vector<BenchResult> results;
+
+    // Only benchmarks whose name contains this run (empty runs everything)
+    std::string filter;
+
+    void addResult(const std::string &name, const std::string &params, std::vector<double> &samples);
+
+public:
+    BenchSuite(const std::string &filter);
+
+    bool wants(const std::string &name) const;
+
+    // Time iteration_fn individually over a number of iterations, after a short warm-up
+    template <typename Func>
+    void run(const std::string &name, const std::string &params, int iterations, Func iteration_fn)
+    {
+        if (!wants(name))
+            return;
+
+        int warmup = std::min(iterations / 10 + 1, 10);
+        for (int i = 0; i < warmup; i++)
+            iteration_fn();
+
+        std::vector<double> samples;
+        samples.reserve(iterations);
+
+        for (int i = 0; i < iterations; i++)
+        {
+            BenchClock::time_point start = BenchClock::now();
+            iteration_fn();
+            std::chrono::duration<double, std::micro> elapsed = BenchClock::now() - start;
+            samples.push_back(elapsed.count());
+        }
+
+        addResult(name, params, samples);
+    }
+
+    // Record a benchmark that was timed elsewhere (one sample per iteration)
+    void record(const std::string &name, const std::string &params, std::vector<double> &samples_us);
+
+    void writeJson(FILE *file) const;
+};
+
+// Benchmark groups
+void benchQueries(BenchSuite &suite);
+void benchGame(BenchSuite &suite, bool has_window);
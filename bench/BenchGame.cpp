@@ -0,0 +1,294 @@
+// Benchmarks of the game's own code paths: map bake, collision, sprite sort, orders, easing, a full day
+
+#include "Bench.hpp"
+
+static const int bench_screen_w = 640;
+static const int bench_screen_h = 384;
+static const int bench_sim_hz = 60;
+static const uint64_t bench_seed = 1;
+
+// Reaches into App's private systems and helpers (App declares it as a friend)
+struct AppBench
+{
+    static flecs::world &world(App &app)
+    {
+        return *app.ecs_world;
+    }
+
+    static void collisionAndDynamicBody(App &app, flecs::entity e, plt::Position &pos, plt::Collider &coll)
+    {
+        app.CollisionSystem(e, pos, coll);
+        app.DynamicBodySystem(e, pos, coll, 0);
+    }
+
+    static plt::Order getRandomOrder(App &app, int number_of_sides)
+    {
+        return app.getRandomOrder(number_of_sides);
+    }
+};
+
+// ==================================================
+// Map::Map: load and GID table, then baking every chunk into its render targets
+// ==================================================
+static void benchMapBake(BenchSuite &suite, bool has_window)
+{
+    suite.run("map_load_headless", "", 50, [&]()
+              {
+                  flecs::world world;
+                  Map map(&world, true, nullptr); //
+              });
+
+    // The bake itself draws into render targets, it needs a GL context
+    if (!has_window)
+        return;
+
+    // No atlas is loaded, so the tiles come from the separate tileset textures like before
+    suite.run("map_bake", "", 20, [&]()
+              {
+                  SpriteAtlas atlas;
+                  flecs::world world;
+                  Map map(&world, false, &atlas);
+                  map.prefetch(map.getBounds()); //
+              });
+
+    // Index textures + shader instead of baked chunks
+    suite.run("map_shader_setup", "", 20, [&]()
+              {
+                  SpriteAtlas atlas;
+                  flecs::world world;
+                  Map map(&world, false, &atlas);
+                  map.setRenderMode(MapRenderMode_Shader); //
+              });
+}
+
+// ==================================================
+// CollisionSystem + DynamicBodySystem with scaled collider counts
+// ==================================================
+static void benchDynamicBodies(BenchSuite &suite, int solid_count)
+{
+    App app(bench_screen_w, bench_screen_h, bench_sim_hz, true, bench_seed);
+    flecs::world &world = AppBench::world(app);
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> coord_dist(0, 2048);
+
+    // Solid bodies scattered over a map several screens wide, the broadphase keeps them in the grid
+    for (int i = 0; i < solid_count; i++)
+    {
+        flecs::entity e = world.entity();
+        e.set<plt::Position>({coord_dist(gen), coord_dist(gen), 0});
+        e.set<plt::Collider>({Rectangle{0, 0, 32, 32}, c2AABB{}});
+        e.set<plt::SolidBody>({1});
+    }
+
+    int dynamic_count = std::max(solid_count / 10, 10);
+    for (int i = 0; i < dynamic_count; i++)
+    {
+        flecs::entity e = world.entity();
+        e.set<plt::Position>({coord_dist(gen), coord_dist(gen), 0});
+        e.set<plt::Collider>({Rectangle{-8, -8, 16, 16}, c2AABB{}});
+        e.set<plt::DynamicBody>({1});
+    }
+
+    flecs::query<plt::Position, plt::Collider, plt::DynamicBody> dynamic_q = world.query<plt::Position, plt::Collider, plt::DynamicBody>();
+
+    // Every iteration starts from the same positions, so each one resolves the same contacts
+    std::vector<plt::Position> start_positions;
+    dynamic_q.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll, plt::DynamicBody &dyn)
+                   {
+                       start_positions.push_back(pos); //
+                   });
+
+    std::string params = "solids=" + std::to_string(solid_count) + " dynamics=" + std::to_string(dynamic_count);
+
+    suite.run("dynamic_body_system", params, 200, [&]()
+              {
+                  int i = 0;
+                  dynamic_q.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll, plt::DynamicBody &dyn)
+                                 {
+                                     pos = start_positions[i++];
+                                     AppBench::collisionAndDynamicBody(app, e, pos, coll); //
+                                 });
+              });
+}
+
+// ==================================================
+// A whole simulation tick with the multi-threaded systems split over 1..n threads
+// ==================================================
+static void benchThreadedSim(BenchSuite &suite, int body_count)
+{
+    int max_threads = std::max((int)std::thread::hardware_concurrency(), 1);
+
+    // Idle on the main menu, so the tick is dominated by the snapshot/collision/dynamic body systems
+    plt::InputState idle = {};
+    idle.menu_select = plt::MenuSelect_None;
+
+    for (int threads = 1; threads <= std::min(max_threads, 16); threads *= 2)
+    {
+        App app(bench_screen_w, bench_screen_h, bench_sim_hz, true, bench_seed);
+        app.setThreadCount(threads);
+
+        flecs::world &world = AppBench::world(app);
+
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> coord_dist(0, 4096);
+
+        for (int i = 0; i < body_count; i++)
+        {
+            flecs::entity solid_e = world.entity();
+            solid_e.set<plt::Position>({coord_dist(gen), coord_dist(gen), 0});
+            solid_e.set<plt::Collider>({Rectangle{0, 0, 32, 32}, c2AABB{}});
+            solid_e.set<plt::SolidBody>({1});
+
+            flecs::entity dynamic_e = world.entity();
+            dynamic_e.set<plt::Position>({coord_dist(gen), coord_dist(gen), 0});
+            dynamic_e.set<plt::PrevPosition>({0, 0});
+            dynamic_e.set<plt::Collider>({Rectangle{-8, -8, 16, 16}, c2AABB{}});
+            dynamic_e.set<plt::DynamicBody>({1});
+        }
+
+        std::string params = "bodies=" + std::to_string(body_count) + " threads=" + std::to_string(threads);
+
+        suite.run("threaded_sim_tick", params, 100, [&]()
+                  {
+                      app.stepHeadless(idle); //
+                  });
+    }
+}
+
+// ==================================================
+// SpriteBatch sort (quantized keys, radix sort), as RenderSystem does every frame
+// ==================================================
+static void benchSpriteSort(BenchSuite &suite, int sprite_count)
+{
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> y_dist(0, bench_screen_h);
+
+    // A few fake textures, the batcher only looks at their ids when sorting
+    Texture2D textures[4] = {};
+    for (int i = 0; i < 4; i++)
+        textures[i].id = i + 1;
+
+    std::vector<float> y_levels(sprite_count);
+    for (auto &y : y_levels)
+        y = y_dist(gen);
+
+    SpriteBatch batch(sprite_count);
+
+    // Includes queueing the sprites, like the per-frame rebuild
+    suite.run("sprite_batch_sort", "sprites=" + std::to_string(sprite_count), 500, [&]()
+              {
+                  batch.clear();
+                  for (int i = 0; i < sprite_count; i++)
+                      batch.add(textures[i % 4], Rectangle{0, 0, 32, 32}, Vector2{0, y_levels[i]}, WHITE, y_levels[i]);
+                  batch.sort(); //
+              });
+}
+
+// ==================================================
+// App::getRandomOrder
+// ==================================================
+static void benchRandomOrder(BenchSuite &suite)
+{
+    App app(bench_screen_w, bench_screen_h, bench_sim_hz, true, bench_seed);
+
+    const int batch = 100;
+    int completion_sink = 0;
+
+    for (int sides : {2, 5})
+    {
+        suite.run("get_random_order", "sides=" + std::to_string(sides) + " batch=" + std::to_string(batch), 200, [&]()
+                  {
+                      for (int i = 0; i < batch; i++)
+                          completion_sink += AppBench::getRandomOrder(app, sides).part_count; //
+                  });
+    }
+
+    if (completion_sink == -1)
+        fprintf(stderr, "%d\n", completion_sink);
+}
+
+// ==================================================
+// processLoopingEase / getEasingFunction
+// ==================================================
+static void benchEasing(BenchSuite &suite)
+{
+    const int batch = 10000;
+
+    // The three eases App updates every frame
+    plt::LoopingEase eases[3] = {
+        {0.0, 20, 20, true, -1, 1, EaseInOutCubic},
+        {0.0, 10, 10, true, 0.1, 0.3, EaseInOutCubic},
+        {0.0, 5, 5, true, 0, 10, EaseInOutCubic},
+    };
+
+    suite.run("process_looping_ease", "batch=" + std::to_string(batch), 200, [&]()
+              {
+                  for (int i = 0; i < batch; i++)
+                      processLoopingEase(eases[i % 3], 1.f / 60.f); //
+              });
+
+    float sink = 0;
+    suite.run("get_easing_function", "batch=" + std::to_string(batch), 200, [&]()
+              {
+                  for (int i = 0; i < batch; i++)
+                      sink += getEasingFunction((easing_functions)(i % (EaseInOutBounce + 1)))(0.5); //
+              });
+
+    if (sink == -1)
+        fprintf(stderr, "%f\n", sink);
+}
+
+// ==================================================
+// A full headless day: menu, intro dialogue and Day 1 with scripted input
+// ==================================================
+static void benchHeadlessDay(BenchSuite &suite)
+{
+    // Scripted input rarely finishes the orders, so a "day" is capped at five simulated minutes
+    const int max_ticks = bench_sim_hz * 60 * 5;
+
+    std::vector<double> samples;
+    int ticks = 0;
+
+    for (int run = 0; run < 3; run++)
+    {
+        App app(bench_screen_w, bench_screen_h, bench_sim_hz, true, bench_seed);
+
+        BenchClock::time_point start = BenchClock::now();
+
+        for (ticks = 0; ticks < max_ticks && app.getGameState() < plt::GameState_Day2Intro; ticks++)
+            app.stepHeadless(App::getScriptedInput(ticks, bench_sim_hz));
+
+        std::chrono::duration<double, std::micro> elapsed = BenchClock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+
+    suite.record("headless_day", "ticks=" + std::to_string(ticks), samples);
+}
+
+void benchGame(BenchSuite &suite, bool has_window)
+{
+    benchMapBake(suite, has_window);
+
+    if (suite.wants("dynamic_body_system"))
+    {
+        benchDynamicBodies(suite, 100);
+        benchDynamicBodies(suite, 1000);
+        benchDynamicBodies(suite, 10000);
+    }
+
+    if (suite.wants("threaded_sim_tick"))
+        benchThreadedSim(suite, 20000);
+
+    benchSpriteSort(suite, 64);
+    benchSpriteSort(suite, 1024);
+    benchSpriteSort(suite, 50000);
+
+    if (suite.wants("get_random_order"))
+        benchRandomOrder(suite);
+
+    benchEasing(suite);
+
+    if (suite.wants("headless_day"))
+        benchHeadlessDay(suite);
+}
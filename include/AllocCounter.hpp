@@ -0,0 +1,21 @@
+#pragma once
+#include "main.hpp"
+
+// Debug heap allocation counter
+//  - With PLT_COUNT_ALLOCS (Debug builds) the global operator new is replaced to count every
+//    C++ heap allocation; C allocations inside raylib/flecs aren't seen
+//  - Without it getAllocCount() is always 0 and costs nothing
+
+#ifdef PLT_COUNT_ALLOCS
+
+// Allocations made through operator new since startup, on any thread
+uint64_t getAllocCount();
+
+#else
+
+inline uint64_t getAllocCount()
+{
+    return 0;
+}
+
+#endif
@@ -1,23 +1,88 @@
 #pragma once
 #include "main.hpp"
 
+// Utility functions (App.cpp)
+void processLoopingEase(plt::LoopingEase &le, float dt);
+c2AABB rectToAABB(Rectangle rec);
+
+// Tick rates the fixed-step simulation supports: slower ticks step the bodies through each other,
+// faster ones can't catch up on a long (clamped to 0.25s) frame
+const int App_MinSimHz = 10;
+const int App_MaxSimHz = 1000;
+
 class App
 {
 private:
+    // The benchmark suite (bench/) and tests (tests/) drive systems and helpers directly
+    friend struct AppBench;
+    friend struct AppAllocTest;
+
     int screen_w;
     int screen_h;
 
+    // Broadphase for solid bodies, kept in sync by observers (declared first so it outlives the world)
+    std::unique_ptr<SpatialGrid> solid_grid;
+
+    // Broadphase results, one scratch list per flecs stage (worker thread)
+    std::vector<std::vector<int>> nearby_solids;
+
     // World Values
     std::unique_ptr<flecs::world> ecs_world;
     std::unique_ptr<Map> map;
 
+    // Run the simulation only, without a window, GPU resources or the render system
+    bool headless;
+
+    // Random streams, all derived from one seed
+    uint64_t seed;
+    Rng order_rng;
+    Rng customer_rng;
+
     // Counter for speedrunning
     float time_counter;
 
+    // Fixed-step simulation
+    //--------------------------------------------------------------------------------------
+    // Seconds per simulation tick
+    float sim_step;
+
+    // Unsimulated time carried over between frames
+    float sim_accumulator;
+
+    // Where the rendered frame sits between the last two simulation ticks (0-1)
+    float sim_alpha;
+
+    flecs::entity sim_pipeline;
+    flecs::entity render_pipeline;
+
+    // Run one simulation tick with the current input
+    void stepSimulation();
+    //--------------------------------------------------------------------------------------
+
+    // Input
+    //--------------------------------------------------------------------------------------
+    // Input gathered since the last tick
+    plt::InputState frame_input;
+
+    // Input seen by the simulation systems this tick
+    plt::InputState tick_input;
+
+    // Menu option clicked in the GUI, handed to the next simulation tick
+    int pending_menu_select;
+
+    // Every tick's input while recording, for replaying the run later
+    std::unique_ptr<InputLog> input_recording;
+
+    void pollInput();
+    //--------------------------------------------------------------------------------------
+
     // Debug GUI Values
     bool render_colliders;
     bool render_positions;
 
+    // Per-system timing overlay, toggled with F3
+    std::unique_ptr<Profiler> profiler;
+
     // Audio Values
     bool is_audio_initialized;
 
@@ -43,24 +108,30 @@ private:
     //--------------------------------------------------------------------------------------
 
     // Textures
+    //  - Every sprite sheet is drawn through the sprite atlas, the handles below are its sheets
     //--------------------------------------------------------------------------------------
-    // Player Texture
-    Texture2D player_tex;
+    std::unique_ptr<SpriteAtlas> sprite_atlas;
+
+    // Player Sheet
+    int player_sheet;
+
+    // Logo Sheet
+    int logo_sheet;
 
-    // Logo Texture
-    Texture2D logo_tex;
+    // Food Sheet
+    int meals_sheet;
 
-    // Food Texture
-    Texture2D meals_tex;
+    // Customer Sheet
+    int customer_sheet;
 
-    // Customer Texture
-    Texture2D customer_tex;
-    
-    // Devil Texture
-    Texture2D devil_tex;
+    // Devil Sheet
+    int devil_sheet;
 
-    // Outro Texture
-    Texture2D outro_tex;
+    // Outro Sheet
+    int outro_sheet;
+
+    // DrawTexturePro with a sheet's original source rect, resolved through the atlas
+    void drawSprite(int sheet, Rectangle src, Rectangle dest, Color color);
     //--------------------------------------------------------------------------------------
 
     // Audio
@@ -76,22 +147,46 @@ private:
     plt::LoopingEase inv_scale;
     plt::LoopingEase text_y_add;
 
-    // Vector of sprites to be rendered, sorted by y-values
-    std::vector<plt::SPR> render_orders;
+    // Sprites to be rendered this frame, sorted by y-values
+    std::unique_ptr<SpriteBatch> sprite_batch;
+
+    // Render temporaries (labels), reset every frame
+    std::unique_ptr<FrameArena> frame_arena;
 
-    // List of available ingredients
-    std::vector<plt::Ingredient> ingredients;
-    std::vector<plt::Dish> dishes;
+    // Frames rendered in the current game state, rendering must stop allocating once warmed up
+    plt::GameState render_game_state;
+    int render_state_frames;
+
+    // Heap allocations made drawing the last frame (always 0 without PLT_COUNT_ALLOCS)
+    uint64_t render_frame_allocs;
+    bool render_alloc_warned;
+
+    // Item catalog: one prefab per ingredient/dish holding its shared info (name, sprite, properties)
+    //  - Item entities are instances (IsA) of their prefab and only own their mutable state
+    //  - An item's id is the index of its prefab in these lists
+    std::vector<flecs::entity_t> ingredient_prefabs;
+    std::vector<flecs::entity_t> dish_prefabs;
     std::vector<Vector2> bowl_fills;
 
+    // Picked item entities, recycled instead of created and destructed per pick
+    std::unique_ptr<ItemPool> item_pool;
+
     void initFood();
+    void addIngredientPrefab(const char *name, Vector2 pos, bool cookable);
+    void addDishPrefab(const char *name, plt::DishType type, Vector2 pos);
+
+    const plt::IngredientInfo &getIngredientInfo(int id);
+    const plt::DishInfo &getDishInfo(int id);
+
+    // Apply the option picked in the player's open menu (bag, dishes, sink, cutting board, stove)
+    void applyMenuSelection(flecs::entity e, plt::Player &player, const plt::HeldItem &held, int select);
 
     void renderBagMenu(flecs::entity e, plt::Position &pos, plt::Player &player);
     void renderDishMenu(flecs::entity e, plt::Position &pos, plt::Player &player);
     void renderSinkMenu(flecs::entity e, plt::Position &pos, plt::Player &player);
-    void renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Player &player);
-    void renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &player);
-    void renderPlayerInventory(flecs::entity e, plt::Position &pos, plt::Player &player);
+    void renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held);
+    void renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held);
+    void renderPlayerInventory(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held);
 
     // Order Functions
     void addDishToOrder(plt::Order &o, plt::Dish dish);
@@ -99,17 +194,19 @@ private:
     plt::Order getRandomOrder(int number_of_sides);
 
     void renderDevil(Rectangle target, Color color);
-    void renderIngredient(plt::Ingredient &ing, Rectangle target, Color color);
-    void renderDish(plt::Dish &dish, Rectangle target, Color color);
+    void renderIngredient(const plt::Ingredient &ing, Rectangle target, Color color);
+    void renderDish(const plt::Dish &dish, Rectangle target, Color color);
 
     void renderIngredientInstr(plt::Ingredient &ing, Vector2 pt, bool done);
     void renderDishInstr(plt::Dish &dish, Vector2 pt, bool done);
     void renderOrderInstr(plt::Order &order);
 
-    bool areIngredientsEqual(plt::Ingredient &a, plt::Ingredient &b);
-    bool areDishesEqual(plt::Dish &a, plt::Dish &b);
+    bool isPlayerHoldingRightPiece(const plt::HeldItem &held, plt::Order &order);
 
-    bool isPlayerHoldingRightPiece(plt::Player &player, plt::Order &order);
+    // The item a player holds (entity and owned state), one target lookup instead of one per use
+    plt::HeldItem getHeldItem(flecs::entity player_e, const plt::Player &player);
+    void holdItem(flecs::entity player_e, plt::Player &player, flecs::entity item, plt::PlayerHoldingType type);
+    void releaseHeldItem(flecs::entity player_e, plt::Player &player, const plt::HeldItem &held);
 
     // ECS
     //--------------------------------------------------------------------------------------
@@ -117,6 +214,20 @@ private:
     // Initialize systems and attatch them to the ECS world
     void initSystems();
 
+    // Cached queries, created in initSystems
+    flecs::query<plt::CookingZone> cooking_zone_q;
+    flecs::query<plt::Position, plt::Player> player_q;
+    flecs::query<plt::Position, plt::PrevPosition, plt::Player> player_sprite_q;
+    flecs::query<plt::Position, plt::Collider> collider_q;
+    flecs::query<plt::Position> position_q;
+
+    // (Holds, $item) with the item's optional Ingredient/Dish, run with $this set to a player (see getHeldItem)
+    flecs::rule<> held_item_r;
+    int held_item_var;
+
+    // Remember this tick's starting positions for render interpolation
+    void SnapshotSystem(flecs::entity e, plt::Position &pos, plt::PrevPosition &prev);
+
     // Get input from player
     void PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player);
 
@@ -124,24 +235,50 @@ private:
     void CollisionSystem(flecs::entity e, plt::Position &pos, plt::Collider &coll);
 
     // Handle collisions for dynamic bodies
-    void DynamicBodySystem(flecs::entity e, plt::Position &pos, plt::Collider &coll);
+    void DynamicBodySystem(flecs::entity e, plt::Position &pos, plt::Collider &coll, int stage);
 
     // Handle Customers and Orders
     void CustomerSystem();
 
+    // Menu start, dialogue and speedrun timer
+    void GameStateSystem();
+
     // Render the world after all updates
     void RenderSystem();
+    void renderScene();
+    void renderDebugOverlay();
 
     //--------------------------------------------------------------------------------------
 
     // Render Util
     void drawAttentionArrow(Vector2 target);
-    void drawTutorialText(std::string text);
+    void drawTutorialText(const char *text);
     void drawPulseRect(Rectangle pulse_rec);
 
 public:
-    App(int screen_w, int screen_h);
+    App(int screen_w, int screen_h, int sim_hz, bool headless, uint64_t seed);
     ~App();
 
     void runFrame();
+
+    // Headless driving: run one simulation tick with scripted input
+    void stepHeadless(const plt::InputState &input);
+
+    // Deterministic input for headless runs and benchmarks
+    static plt::InputState getScriptedInput(int tick, int sim_hz);
+
+    // Record the input of every following tick, together with the seed
+    void startRecording();
+    bool saveRecording(const char *path);
+
+    plt::GameState getGameState();
+    float getTimeCounter();
+    int getCustomerCount();
+    uint64_t getSeed();
+
+    // Run the multi-threaded simulation systems (snapshot, collision, dynamic bodies) on n threads
+    void setThreadCount(int n);
+
+    // Baked chunks (default) or the tile index shader, false if the mode isn't available
+    bool setMapRenderMode(MapRenderMode mode);
 };
\ No newline at end of file
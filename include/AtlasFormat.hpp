@@ -0,0 +1,83 @@
+#pragma once
+
+// Sprite atlas format
+//  - Produced offline by SpeedJam5_atlaspack from the sprite sheets and the map's tilesets
+//  - Only the cells the game references are packed, the remap table keeps every original
+//    source rectangle resolvable (see SpriteAtlas)
+//  - Every section starts on a 4-byte boundary, all values are little endian
+//
+// Layout:
+//      AtlasBinHeader
+//      AtlasBinPage[page_count]
+//      AtlasBinSource[source_count]
+//      AtlasBinCell[cell_count], columns * rows per source, row-major
+
+#include <stdint.h>
+#include <string.h>
+
+namespace plt
+{
+    const uint32_t AtlasBin_Magic = 0x414A5350; // "PSJA"
+    const uint32_t AtlasBin_Version = 1;
+
+    // Biggest page the packer makes, safe for WebGL 1 devices
+    const int AtlasBin_MaxPageSize = 2048;
+
+    // Transparent gap around every packed cell, its edges are extruded into it so filtering never bleeds
+    const int AtlasBin_Padding = 1;
+
+    struct AtlasBinHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t file_size;
+
+        uint32_t page_count;
+        uint32_t source_count;
+        uint32_t cell_count;
+
+        // Byte offsets from the start of the file
+        uint32_t page_offset;
+        uint32_t source_offset;
+        uint32_t cell_offset;
+    };
+
+    // A packed page image
+    struct AtlasBinPage
+    {
+        int32_t width;
+        int32_t height;
+
+        // Image file name (no directories), null terminated
+        char image[120];
+    };
+
+    // An original sprite sheet / tileset, cut into a grid of cells
+    struct AtlasBinSource
+    {
+        int32_t cell_w;
+        int32_t cell_h;
+        int32_t columns;
+        int32_t rows;
+
+        // Index of the source's first AtlasBinCell
+        uint32_t first_cell;
+
+        // Image file name (no directories), null terminated
+        char image[108];
+    };
+
+    // Where a cell of a source ended up, page -1 if it wasn't packed
+    struct AtlasBinCell
+    {
+        int16_t page;
+        uint16_t x;
+        uint16_t y;
+        uint16_t unused;
+    };
+
+    static_assert(sizeof(AtlasBinHeader) == 36, "AtlasBinHeader layout changed, bump AtlasBin_Version");
+    static_assert(sizeof(AtlasBinPage) == 128, "AtlasBinPage layout changed, bump AtlasBin_Version");
+    static_assert(sizeof(AtlasBinSource) == 128, "AtlasBinSource layout changed, bump AtlasBin_Version");
+    static_assert(sizeof(AtlasBinCell) == 8, "AtlasBinCell layout changed, bump AtlasBin_Version");
+}
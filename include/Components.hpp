@@ -57,34 +57,81 @@ namespace plt
         DishType_Bowl
     };
 
-    struct Dish
+    // Catalog entries, set once on each item's prefab and shared by every instance through IsA
+    struct DishInfo
     {
         std::string name;
         DishType type;
         Vector2 pos;
-        BowlFillType fill;
     };
 
-    struct Ingredient
+    struct IngredientInfo
     {
         std::string name;
         Vector2 pos;
         bool cookable;
+    };
+
+    // Dish item: catalog id + how it's been filled (the only data an instance owns)
+    struct Dish
+    {
+        uint16_t id;
+        BowlFillType fill;
+    };
+
+    // Ingredient item: catalog id + how it's been cut/cooked (the only data an instance owns)
+    struct Ingredient
+    {
+        uint16_t id;
         IngredientState state;
     };
 
-    // A restaurant order
-    struct Order
+    // Packed identity of an item, two items match exactly when their keys are equal
+    //  - Bits 24-31: ItemKind
+    //  - Bits 8-23:  Catalog id
+    //  - Bits 0-7:   IngredientState or BowlFillType
+    typedef uint32_t ItemKey;
+
+    enum ItemKind
     {
-        std::vector<Dish> dishes;
-        std::vector<Ingredient> ingredients;
+        ItemKind_Dish,
+        ItemKind_Ingredient
+    };
 
-        // Pair where:
-        // - First: 0 for dishes, 1 for ingredients
-        // - Second: Index in the respective list
-        std::vector<std::pair<int, int>> indicies;
+    inline ItemKey makeItemKey(ItemKind kind, int id, int variant)
+    {
+        return ((uint32_t)kind << 24) | ((uint32_t)id << 8) | (uint32_t)variant;
+    }
 
-        int completion;
+    inline ItemKey makeItemKey(const Dish &dish)
+    {
+        return makeItemKey(ItemKind_Dish, dish.id, dish.fill);
+    }
+
+    inline ItemKey makeItemKey(const Ingredient &ing)
+    {
+        return makeItemKey(ItemKind_Ingredient, ing.id, ing.state);
+    }
+
+    inline ItemKind getItemKind(ItemKey key) { return (ItemKind)(key >> 24); }
+    inline int getItemId(ItemKey key) { return (key >> 8) & 0xFFFF; }
+    inline int getItemVariant(ItemKey key) { return key & 0xFF; }
+
+    inline Dish getItemDish(ItemKey key) { return Dish{(uint16_t)getItemId(key), (BowlFillType)getItemVariant(key)}; }
+    inline Ingredient getItemIngredient(ItemKey key) { return Ingredient{(uint16_t)getItemId(key), (IngredientState)getItemVariant(key)}; }
+
+    // A restaurant order, stored inline so customers can be copied around as plain data
+    //  - Day 3 orders are the biggest: a dish + 5 sides
+    const int Order_MaxParts = 8;
+
+    struct Order
+    {
+        // Items to plate, in order
+        ItemKey parts[Order_MaxParts];
+        uint8_t part_count;
+
+        // Parts plated so far (the next one needed is parts[completion])
+        uint8_t completion;
     };
 
     //--------------------------------------------------------------------------------------
@@ -95,6 +142,14 @@ namespace plt
         float x, y, rotation;
     };
 
+    //--------------------------------------------------------------------------------------
+    // Position at the previous simulation tick, rendering interpolates from it
+    //--------------------------------------------------------------------------------------
+    struct PrevPosition
+    {
+        float x, y;
+    };
+
     //--------------------------------------------------------------------------------------
     // Entity position and rotation (in degrees)
     //--------------------------------------------------------------------------------------
@@ -157,16 +212,30 @@ namespace plt
 
         uint8_t current_frame;
 
-        // Item the player is holding
-        flecs::entity_t item;
-
-        // Type of item the player is holding
+        // Type of item the player is holding (the item itself is the target of the player's (Holds, item) pair)
         PlayerHoldingType holding_type;
 
         // Interacting with cooking zone
         CookingZoneType cooking_zone;
     };
 
+    // Relationship: (Holds, item) is on a player while it carries item
+    //  - Exclusive, holding a new item replaces the old pair
+    //  - Removed automatically if the item entity is ever deleted
+    struct Holds
+    {
+    };
+
+    // A player's held item, resolved once per system call from its (Holds, item) pair
+    //  - ing/dish point straight at the item's owned state, whichever one it has (read only,
+    //    writes go through entity so they're staged when systems run on worker threads)
+    struct HeldItem
+    {
+        flecs::entity entity;
+        const Ingredient *ing;
+        const Dish *dish;
+    };
+
     //--------------------------------------------------------------------------------------
     // Customers
     //--------------------------------------------------------------------------------------
@@ -200,6 +269,50 @@ namespace plt
         Color col;
 
         Vector2 pos;
+        Vector2 prev_pos;
+    };
+
+    static_assert(std::is_trivially_copyable<Customer>::value, "customers are copied as plain data");
+
+    //--------------------------------------------------------------------------------------
+    // Input for one simulation tick (sampled from raylib, or scripted when headless)
+    //--------------------------------------------------------------------------------------
+    enum MenuSelect
+    {
+        MenuSelect_None = -1,
+        MenuSelect_Exit = -2
+    };
+
+    struct InputState
+    {
+        // Movement (WASD)
+        bool up, down, left, right;
+
+        // Interaction key (E)
+        bool interact;
+
+        // Dialogue continue/skip (SPACE), pressed since the last tick
+        bool advance;
+
+        Vector2 mouse;
+        bool mouse_left;
+
+        // Option picked in the open menu: an index, MenuSelect_Exit or MenuSelect_None
+        int menu_select;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Pipeline Phases
+    //--------------------------------------------------------------------------------------
+
+    // Systems stepped at the fixed simulation rate
+    struct SimulationPhase
+    {
+    };
+
+    // Systems run once per rendered frame
+    struct RenderPhase
+    {
     };
 
     //--------------------------------------------------------------------------------------
@@ -229,20 +342,7 @@ namespace plt
     };
 
     //--------------------------------------------------------------------------------------
-    // Sprite Render Order (or Instruction) (for y-level rendering)
-    //--------------------------------------------------------------------------------------
-    struct SPR
-    {
-        float y_level;
-
-        Texture2D tex;
-        Rectangle source;
-        Vector2 position;
-        Color color;
-    };
-
-    //--------------------------------------------------------------------------------------
-    // Sprite Render Order (or Instruction) (for y-level rendering)
+    // Looping Ease (inventory and text animation)
     //--------------------------------------------------------------------------------------
     struct LoopingEase
     {
@@ -0,0 +1,95 @@
+#pragma once
+
+// Ingredient and dish catalog: where every item sits on meals.png
+//  - App::initFood turns the tables into prefabs
+//  - SpeedJam5_atlaspack packs exactly these cells into the sprite atlas
+
+namespace plt
+{
+    // Sprite sheet the catalog points into, and its cell size
+    const char *const FoodCatalog_Image = "meals.png";
+    const int FoodCatalog_Cell = 32;
+
+    // Rows below an ingredient's position, one per IngredientState
+    const int FoodCatalog_StateRows = 9;
+
+    struct IngredientDef
+    {
+        const char *name;
+        float x, y;
+        bool cookable;
+    };
+
+    struct DishDef
+    {
+        const char *name;
+
+        // DishType
+        int type;
+        float x, y;
+    };
+
+    struct FoodCell
+    {
+        float x, y;
+    };
+
+    const IngredientDef ingredient_defs[] = {
+        // Vegetables
+        {"Melon", 0, 64, false},
+        {"Carrot", 32, 64, false},
+        {"White Carrot", 64, 64, false},
+        {"Potato", 128, 64, false},
+        {"Yam", 224, 64, false},
+        {"Purple Yam", 320, 64, false},
+        {"Tomato", 384, 64, false},
+
+        {"Chicken Leg", 0, 512, true},
+        {"Sausage", 64, 512, true},
+
+        {"Corn", 448, 64, false},
+        {"Onion", 480, 64, false},
+        {"Red Onion", 512, 64, false},
+        {"Purple Onion", 544, 64, false},
+        {"Green Pepper", 576, 64, false},
+        {"Red Pepper", 608, 64, false},
+        {"Orange Pepper", 640, 64, false},
+
+        {"Bacon", 96, 512, true},
+        {"Flank", 128, 512, true},
+
+        {"Yellow Pepper", 672, 64, false},
+        {"Brussel Sprouts", 736, 64, false},
+        {"Cauliflower", 768, 64, false},
+        {"Broccoli", 800, 64, false},
+        {"Squash", 864, 64, false},
+        {"Cucumber", 896, 64, false},
+        {"Radish", 928, 64, false},
+
+        {"Meatballs", 160, 512, true},
+        {"Steak", 224, 512, true},
+
+        {"Turnip", 960, 64, false},
+        {"Apple", 800, 512, false},
+        {"Orange", 832, 512, false},
+        {"Pineapple", 896, 512, false},
+        {"Strawberry", 928, 512, false},
+        {"Kiwi", 992, 512, false},
+    };
+
+    const DishDef dish_defs[] = {
+        // Bowls (small at 0,0 and medium at 32,0 are unused)
+        {"Large Bowl", 1, 64, 0},
+
+        // Plates (small at 96,0 and medium at 128,0 are unused)
+        {"Large Plate", 0, 160, 0},
+    };
+
+    // Bowl fills, indexed by BowlFillType - 1
+    const FoodCell bowl_fill_cells[] = {
+        {128, 32},
+        {192, 32},
+        {256, 32},
+        {320, 32},
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "main.hpp"
+
+// Per-frame linear allocator for render temporaries (formatted labels and the like)
+//  - One fixed block, allocated up front; reset() at the start of every frame frees everything at once
+//  - Nothing is destructed, only use it for trivially destructible data
+class FrameArena
+{
+private:
+    std::vector<uint8_t> block;
+    size_t used;
+
+public:
+    FrameArena(size_t capacity);
+
+    void reset();
+
+    // Aligned allocation from the block, asserts if the frame runs out of space
+    void *alloc(size_t size, size_t align = alignof(std::max_align_t));
+
+    // printf into the arena, valid until the next reset()
+    const char *format(const char *fmt, ...);
+
+    size_t getUsed() const;
+};
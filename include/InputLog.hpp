@@ -0,0 +1,86 @@
+#pragma once
+#include "main.hpp"
+
+// Per-tick simulation input, recorded to a compact binary log and replayed deterministically
+//  - Holds the RNG seed and tick rate along with the input, so a log alone reproduces a run
+//  - Identical consecutive ticks are run-length encoded (most ticks repeat the previous one)
+//
+// File layout (little-endian):
+//      InputLogHeader
+//      InputLogRecord[record_count]
+const uint32_t InputLog_Magic = 0x4C494A53; // "SJIL"
+const uint32_t InputLog_Version = 1;
+
+struct InputLogHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sim_hz;
+    uint32_t tick_count;
+    uint64_t seed;
+    uint32_t record_count;
+    uint32_t reserved;
+};
+
+enum InputLogFlags : uint8_t
+{
+    InputLogFlag_Up = 1 << 0,
+    InputLogFlag_Down = 1 << 1,
+    InputLogFlag_Left = 1 << 2,
+    InputLogFlag_Right = 1 << 3,
+    InputLogFlag_Interact = 1 << 4,
+    InputLogFlag_Advance = 1 << 5,
+    InputLogFlag_MouseLeft = 1 << 6,
+};
+
+// One input state, repeated for run ticks
+struct InputLogRecord
+{
+    uint16_t run;
+    uint8_t flags;
+    int8_t menu_select;
+    int16_t mouse_x;
+    int16_t mouse_y;
+};
+
+static_assert(sizeof(InputLogHeader) == 32, "InputLogHeader layout");
+static_assert(sizeof(InputLogRecord) == 8, "InputLogRecord layout");
+
+class InputLog
+{
+private:
+    uint64_t seed;
+    int sim_hz;
+    int tick_count;
+
+    std::vector<InputLogRecord> records;
+
+    // Replay cursor
+    size_t replay_record;
+    int replay_run;
+
+    static InputLogRecord pack(const plt::InputState &input);
+    static plt::InputState unpack(const InputLogRecord &record);
+
+public:
+    InputLog(uint64_t seed, int sim_hz);
+
+    // Append the input of one simulation tick
+    void record(const plt::InputState &input);
+
+    bool save(const char *path) const;
+
+    // Replace this log with the one in path, returns false if it can't be read
+    bool load(const char *path);
+
+    // Replay from the first tick
+    void rewind();
+
+    // Input of the next tick, false once every recorded tick has been replayed
+    bool nextInput(plt::InputState &out);
+
+    uint64_t getSeed() const;
+    int getSimHz() const;
+    int getTickCount() const;
+    size_t getByteSize() const;
+};
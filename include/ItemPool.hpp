@@ -0,0 +1,41 @@
+#pragma once
+#include "main.hpp"
+
+// Recycles the item entities (ingredients and dishes) the player picks, plates and trashes
+//  - Released items stay alive with their item component, reusing one is just a set() on it:
+//    no new entity ids and no table moves once the pool has warmed up
+//  - One free list per prefab, so an entity is only ever reused as an instance of the prefab it already
+//    inherits from (changing the IsA target would move it to another table)
+class ItemPool
+{
+private:
+    // Released entities, by the prefab they are an instance of
+    std::unordered_map<flecs::entity_t, std::vector<flecs::entity_t>> free_items;
+    int free_count;
+
+    int live_count;
+
+    // Counters for the debug overlay
+    uint32_t acquire_count;
+    uint32_t hit_count;
+
+    flecs::entity acquire(const flecs::world &world, flecs::entity_t prefab);
+
+public:
+    ItemPool();
+
+    // An instance of prefab (the ingredient/dish's catalog entry) owning only ing/dish
+    //  - world is the world or stage the caller runs in, new items are created through it
+    flecs::entity acquireIngredient(const flecs::world &world, flecs::entity_t prefab, plt::Ingredient ing);
+    flecs::entity acquireDish(const flecs::world &world, flecs::entity_t prefab, plt::Dish dish);
+
+    // Hand an item back once it's been plated or trashed
+    void release(flecs::entity item);
+
+    int getLiveCount() const;
+    int getFreeCount() const;
+    uint32_t getAcquireCount() const;
+
+    // Fraction of acquires served from the free lists (0-1)
+    float getHitRate() const;
+};
@@ -3,31 +3,226 @@
 
 struct TilesetInfo
 {
-    cute_tiled_tileset_t info;
+    int firstgid;
+    int tilecount;
+    int columns;
+
+    // Image file name, relative to the assets root
+    std::string image;
+
+    // The tileset's sheet in the sprite atlas
+    int atlas_source;
+
+    // The whole tileset image, only loaded for the shader renderer (it needs the tileset's grid)
+    Texture2D tex;
+};
+
+// A tile layer, pointing either into the mapped baked file or into the parsed JSON map
+struct MapLayer
+{
+    const int32_t *data;
+    bool front;
+};
+
+// Resolved GID: the tileset it belongs to, and where it's drawn from (resolved through
+// the sprite atlas for the GIDs the layers use, tex is empty for the others)
+struct TileRef
+{
+    int tileset;
+    Texture2D tex;
+    Rectangle src;
+};
+
+// A single tile queued for drawing into a map target
+struct TileDraw
+{
+    Texture2D tex;
+    Rectangle src;
+    Vector2 dest;
+};
+
+// A tile of a front layer, drawn through the SpriteBatch so it's y-sorted with the sprites
+struct MapFrontTile
+{
     Texture2D tex;
+    Rectangle src;
+    Vector2 dest;
+
+    // Bottom edge of the column of front tiles it's part of (the furniture's base)
+    float y_level;
+};
+
+// Chunk size in tiles, a chunk is baked into its own render target
+const int Map_ChunkTiles = 16;
+
+// GPU memory the baked chunks may hold before the least recently drawn ones are evicted
+const size_t Map_ChunkBudgetBytes = 32 * 1024 * 1024;
+
+// A Map_ChunkTiles square of the map
+struct MapChunk
+{
+    // Whether any back layer has a tile in this chunk, empty chunks are never baked
+    bool has_tiles;
+
+    // Index into Map::chunk_targets while baked, -1 otherwise
+    int targets;
+
+    // Frame this chunk was last drawn, for least recently used eviction
+    uint32_t last_used;
+};
+
+// How the tile layers get on screen
+enum MapRenderMode
+{
+    // Layers baked into render targets per chunk (see MapChunk)
+    MapRenderMode_Chunks,
+
+    // Each layer is an index texture (one texel per tile) resolved against the tilesets by a shader
+    MapRenderMode_Shader
+};
+
+// Tilesets the tile shader can sample in one pass, layers using more are drawn in several passes
+const int Map_ShaderTilesets = 4;
+
+// A tile layer as an index texture (front layers have none, they're sprites)
+//  - Texel bytes: local tile id (low, mid, high), tileset index + 1 (0 is empty)
+struct MapIndexLayer
+{
+    Texture2D index_tex;
+    std::vector<uint32_t> texels;
+
+    // Tilesets this layer uses, in groups of Map_ShaderTilesets (one quad each)
+    std::vector<int> tilesets;
 };
 
 class Map
 {
 private:
     std::vector<TilesetInfo> tilesets_info;
+    std::vector<MapLayer> layers;
+
+    // Dense GID -> tileset/source rect table, built once per map load
+    std::vector<TileRef> gid_table;
+
+    // Tiles of the layer being baked, bucketed per tileset texture
+    std::vector<std::vector<TileDraw>> tileset_batches;
 
     flecs::world *ecs_world;
 
+    // Tile textures are resolved through the atlas (unused when headless)
+    SpriteAtlas *atlas;
+
+    // Only the map's entities are created when headless, no textures or targets
+    bool headless;
+
+    int map_w;
+    int map_h;
+    int tile_w;
+    int tile_h;
+
+    //--------------------------------------------------------------------------------------
+    // Map sources
+    //--------------------------------------------------------------------------------------
+
+    // Baked binary map (preferred), memory-mapped when the platform allows it
+    uint8_t *baked_data;
+    size_t baked_size;
+    bool baked_is_mapped;
+
+    // Parsed Tiled JSON map, only used when no baked map is available
     cute_tiled_map_t *map;
 
+    bool loadBaked(const char *path);
+    void unloadBaked();
+    void loadTiled(const char *path);
+
+    // Create the ECS entities for the map's collision rects and objects
+    void addSolidBody(Rectangle rect);
+    void addMapObject(plt::MapObjectKind kind, Rectangle rect);
+
+    void buildGidTable();
+
+    //--------------------------------------------------------------------------------------
+    // Front layers
+    //  - Only the occupied tiles, queued into the SpriteBatch instead of blitting a
+    //    mostly transparent map-sized layer over everything
+    //--------------------------------------------------------------------------------------
+    std::vector<MapFrontTile> front_tiles;
+
+    void buildFrontTiles();
+
+    //--------------------------------------------------------------------------------------
+    // Chunks (back layers)
+    //  - Baked lazily the first time they come into view, drawn only while they overlap it
+    //  - Baked chunks hold a render target, at most max_baked_chunks targets exist;
+    //    past that the least recently drawn chunk gives its target to the next one
+    //--------------------------------------------------------------------------------------
+    int chunks_w;
+    int chunks_h;
+    std::vector<MapChunk> chunks;
+
+    std::vector<RenderTexture2D> chunk_targets;
+
+    // Chunk using each target (-1 while free)
+    std::vector<int> target_owners;
+
+    int max_baked_chunks;
+    uint32_t frame_index;
+
+    void initChunks();
+
+    // Chunk index range overlapping a rectangle (in pixels), false if it's outside the map
+    bool getChunkRange(Rectangle view, int &min_cx, int &min_cy, int &max_cx, int &max_cy) const;
+
+    // Bake a chunk if it isn't already, evicting another one if the budget is used up
+    void ensureBaked(int chunk_index);
+    int acquireTargets();
+    void bakeLayerChunk(const MapLayer &layer, int cx, int cy);
+    void bakeChunk(int chunk_index);
+
+    void drawChunks(Rectangle view);
+
     //--------------------------------------------------------------------------------------
-    // Map targets
+    // Shader tilemap
     //--------------------------------------------------------------------------------------
+    MapRenderMode render_mode;
 
-    // Map portion drawn behind everything else
-    RenderTexture2D map_target;
-    RenderTexture2D map_target_front;
+    std::vector<MapIndexLayer> index_layers;
+
+    Shader tile_shader;
+    int tile_shader_map_size_loc;
+    int tile_shader_tile_size_loc;
+    int tile_shader_slot_tileset_loc;
+    int tile_shader_slot_info_loc;
+    int tile_shader_slot_tex_locs[Map_ShaderTilesets];
+
+    bool initShaderLayers();
+    void drawIndexLayers();
 
 public:
-    Map(flecs::world *ecs_world);
+    Map(flecs::world *ecs_world, bool headless, SpriteAtlas *atlas);
     ~Map();
 
-    void draw();
-    void drawFront();
+    // Map size in pixels
+    Rectangle getBounds() const;
+
+    // Bake the chunks overlapping view ahead of time (avoids a hitch the first time they're drawn)
+    void prefetch(Rectangle view);
+
+    // Draw the map layers behind the sprites, only the chunks overlapping view (in pixels)
+    void draw(Rectangle view);
+
+    // Queue the front layer tiles overlapping view, they're drawn y-sorted with the sprites
+    void queueFront(SpriteBatch &batch, Rectangle view) const;
+
+    // Switch renderers, falls back to chunks (and returns false) if the shader can't be set up
+    bool setRenderMode(MapRenderMode mode);
+    MapRenderMode getRenderMode() const;
+
+    // Change one tile of a back layer (shader mode, the layer data itself is read-only): a single texel upload
+    bool setTile(int layer_index, int column, int row, int gid);
+
+    int getChunkCount() const;
+    int getBakedChunkCount() const;
+    int getFrontTileCount() const;
 };
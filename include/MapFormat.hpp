@@ -0,0 +1,133 @@
+#pragma once
+
+// Baked map format
+//  - Produced offline by SpeedJam5_mapbake from the Tiled JSON export
+//  - Memory-mapped by Map at startup and used in place (no parsing, no copies)
+//  - Every section starts on a 4-byte boundary, all values are little endian
+//
+// Layout:
+//      MapBinHeader
+//      MapBinTileset[tileset_count]
+//      MapBinLayer[layer_count]
+//      MapBinRect[collider_count]
+//      MapBinObject[object_count]
+//      int32_t tile data, map_w * map_h GIDs per layer
+
+#include <stdint.h>
+#include <string.h>
+
+namespace plt
+{
+    const uint32_t MapBin_Magic = 0x4D4A5350; // "PSJM"
+    const uint32_t MapBin_Version = 1;
+
+    // Upper bound on a tileset's firstgid + tilecount, Map allocates one GID table entry per GID
+    // (and the tile shader's index texels hold local ids up to 24 bits)
+    const int32_t MapBin_MaxGid = 1 << 20;
+
+    //--------------------------------------------------------------------------------------
+    // Typed map objects (the Tiled "Objects" layer)
+    //--------------------------------------------------------------------------------------
+    enum MapObjectKind : uint32_t
+    {
+        MapObject_None,
+        MapObject_Spawn,
+        MapObject_Bag,
+        MapObject_Dishes,
+        MapObject_Sink,
+        MapObject_CuttingBoard,
+        MapObject_Stove,
+        MapObject_Trash,
+        MapObject_Plating
+    };
+
+    // Maps a Tiled object name onto its kind, shared by the converter and the JSON fallback
+    inline MapObjectKind mapObjectKindFromName(const char *name)
+    {
+        if (!name)
+            return MapObject_None;
+
+        if (strcmp(name, "Spawn") == 0)
+            return MapObject_Spawn;
+        if (strcmp(name, "Bag") == 0)
+            return MapObject_Bag;
+        if (strcmp(name, "Dishes") == 0)
+            return MapObject_Dishes;
+        if (strcmp(name, "Sink") == 0)
+            return MapObject_Sink;
+        if (strcmp(name, "CuttingBoard") == 0)
+            return MapObject_CuttingBoard;
+        if (strcmp(name, "Stove") == 0)
+            return MapObject_Stove;
+        if (strcmp(name, "Trash") == 0)
+            return MapObject_Trash;
+        if (strcmp(name, "Plating") == 0)
+            return MapObject_Plating;
+
+        return MapObject_None;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // File sections
+    //--------------------------------------------------------------------------------------
+    enum MapBinLayerFlags : uint32_t
+    {
+        MapBinLayer_Front = 1 << 0
+    };
+
+    struct MapBinHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t file_size;
+
+        int32_t map_w;
+        int32_t map_h;
+        int32_t tile_w;
+        int32_t tile_h;
+
+        uint32_t tileset_count;
+        uint32_t layer_count;
+        uint32_t collider_count;
+        uint32_t object_count;
+
+        // Byte offsets from the start of the file
+        uint32_t tileset_offset;
+        uint32_t layer_offset;
+        uint32_t collider_offset;
+        uint32_t object_offset;
+    };
+
+    struct MapBinTileset
+    {
+        int32_t firstgid;
+        int32_t tilecount;
+        int32_t columns;
+
+        // Image file name (no directories), null terminated
+        char image[116];
+    };
+
+    struct MapBinLayer
+    {
+        uint32_t flags;
+
+        // Byte offset of this layer's map_w * map_h GIDs
+        uint32_t data_offset;
+    };
+
+    struct MapBinRect
+    {
+        float x, y, width, height;
+    };
+
+    struct MapBinObject
+    {
+        MapObjectKind kind;
+        MapBinRect rect;
+    };
+
+    static_assert(sizeof(MapBinHeader) == 60, "MapBinHeader layout changed, bump MapBin_Version");
+    static_assert(sizeof(MapBinTileset) == 128, "MapBinTileset layout changed, bump MapBin_Version");
+    static_assert(sizeof(MapBinObject) == 20, "MapBinObject layout changed, bump MapBin_Version");
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "main.hpp"
+
+// Systems timed by the profiler overlay
+enum ProfileSlot
+{
+    ProfileSlot_Snapshot,
+    ProfileSlot_Player,
+    ProfileSlot_Collision,
+    ProfileSlot_DynamicBody,
+    ProfileSlot_Customer,
+    ProfileSlot_GameState,
+    ProfileSlot_Render,
+    ProfileSlot_Count,
+};
+
+// In-game frame profiler
+//  - Per-system CPU time, summed over every simulation tick in a frame (and over every thread
+//    for multi-threaded systems)
+//  - Frame time histogram and min/avg/p99 over a rolling window
+//  - Entity/table counts from the flecs world stats
+//  - Hidden by default: the timers don't read the clock and nothing is aggregated until it's shown
+class Profiler
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    bool visible;
+
+    // Rolling window of frame times (ms), filled as a ring
+    std::vector<float> frame_times;
+    int frame_head;
+    int frame_filled;
+
+    // Rolling window of per-system times (ms), same ring as frame_times
+    std::vector<float> slot_times[ProfileSlot_Count];
+
+    // Time spent in each system since the last endFrame (ms), one row of slots per flecs stage:
+    // worker threads only add to their own row, endFrame sums the rows
+    std::vector<float> stage_accum;
+
+    // Aggregates, refreshed every frame while visible
+    float frame_min;
+    float frame_avg;
+    float frame_p99;
+    float slot_avg[ProfileSlot_Count];
+
+    // Preallocated copy of frame_times for the percentile
+    std::vector<float> sorted_scratch;
+
+    // flecs stats are comparatively heavy, only refreshed a few times per second
+    ecs_world_stats_t world_stats;
+    float stats_timer;
+    int entity_count;
+    int table_count;
+
+    void refreshAggregates();
+    void refreshWorldStats(flecs::world &world);
+
+public:
+    Profiler(int window_frames);
+
+    void toggle();
+    bool isVisible() const { return visible; }
+
+    // Stages (threads) that add times, set before they run
+    void setStageCount(int n);
+
+    void addTime(ProfileSlot slot, float ms, int stage = 0);
+
+    // Close the frame: record its time and reset the per-system accumulators
+    void endFrame(float frame_time, flecs::world &world);
+
+    void draw(int x, int y);
+
+    // Times the enclosing scope into a slot, no-op while the overlay is hidden
+    class Scope
+    {
+    private:
+        Profiler *profiler;
+        ProfileSlot slot;
+        int stage;
+        Clock::time_point start;
+
+    public:
+        Scope(Profiler *profiler, ProfileSlot slot, int stage = 0)
+        {
+            this->profiler = profiler && profiler->isVisible() ? profiler : nullptr;
+            this->slot = slot;
+            this->stage = stage;
+
+            if (this->profiler)
+                start = Clock::now();
+        }
+
+        ~Scope()
+        {
+            if (!profiler)
+                return;
+
+            std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+            profiler->addTime(slot, elapsed.count(), stage);
+        }
+    };
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include "main.hpp"
+
+// Small, fast, seedable PRNG (PCG32, XSH-RR variant)
+//  - Each subsystem owns its own stream, so adding draws in one doesn't shift the others
+//  - Same seed + same stream always gives the same sequence, on every platform
+class Rng
+{
+private:
+    uint64_t state;
+    uint64_t inc;
+
+public:
+    Rng(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        reseed(seed, stream);
+    }
+
+    void reseed(uint64_t seed, uint64_t stream)
+    {
+        state = 0;
+        inc = (stream << 1) | 1;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old_state = state;
+        state = old_state * 6364136223846793005ULL + inc;
+
+        uint32_t xorshifted = (uint32_t)(((old_state >> 18) ^ old_state) >> 27);
+        uint32_t rot = (uint32_t)(old_state >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    // Uniform integer in [0, bound), multiply-shift instead of modulo (bias is negligible for game-sized bounds)
+    int range(int bound)
+    {
+        return (int)(((uint64_t)next() * (uint32_t)bound) >> 32);
+    }
+
+    // Uniform integer in [min, max]
+    int range(int min, int max)
+    {
+        return min + range(max - min + 1);
+    }
+};
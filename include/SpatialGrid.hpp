@@ -0,0 +1,48 @@
+#pragma once
+#include "main.hpp"
+
+// Uniform grid broadphase for solid colliders
+//  - Bodies are bucketed into every cell their AABB overlaps
+//  - Queries only visit the cells a box overlaps, so cost follows local density, not map size
+//  - Cells are hashed, so the grid has no fixed bounds
+class SpatialGrid
+{
+private:
+    struct GridBody
+    {
+        flecs::entity_t entity;
+        c2AABB aabb;
+
+        // Inclusive cell range the body is currently bucketed in
+        int min_cx, min_cy;
+        int max_cx, max_cy;
+    };
+
+    float cell_size;
+
+    std::vector<GridBody> bodies;
+    std::vector<int> free_bodies;
+    std::unordered_map<flecs::entity_t, int> body_lookup;
+
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+
+    static uint64_t cellKey(int cx, int cy);
+    int toCell(float v) const;
+
+    void addToCells(int body);
+    void removeFromCells(int body);
+
+public:
+    SpatialGrid(float cell_size);
+
+    // Insert a body, or move it if it is already in the grid
+    void insert(flecs::entity_t entity, c2AABB aabb);
+    void remove(flecs::entity_t entity);
+    void clear();
+
+    // Collect (once each) the bodies sharing a cell with box, out is cleared first
+    void query(c2AABB box, std::vector<int> &out) const;
+
+    const c2AABB &getAABB(int body) const;
+    int getBodyCount() const;
+};
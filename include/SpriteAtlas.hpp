@@ -0,0 +1,63 @@
+#pragma once
+#include "main.hpp"
+
+// A source rectangle resolved to the texture it's drawn from
+struct AtlasSprite
+{
+    Texture2D tex;
+    Rectangle src;
+};
+
+// Packed sprite atlas (see AtlasFormat.hpp)
+//  - Sprite sheets are looked up by image name and keep using their original source rects
+//  - Packed cells resolve into an atlas page, so most of a frame draws from one texture
+//  - Sheets or cells the atlas doesn't have are drawn from the original image, loaded up front
+//    (or on first use for rects spanning several cells): a stale atlas costs texture switches,
+//    never wrong sprites
+class SpriteAtlas
+{
+private:
+    struct Source
+    {
+        std::string image;
+
+        int cell_w;
+        int cell_h;
+        int columns;
+        int rows;
+        std::vector<plt::AtlasBinCell> cells;
+
+        // The whole original image, -1 until something outside the atlas is drawn from it
+        int fallback_page;
+    };
+
+    // Atlas pages first, then fallback images as they get loaded (capacity for one per source)
+    std::vector<Texture2D> pages;
+    int packed_page_count;
+
+    std::vector<Source> sources;
+
+    int getFallbackPage(Source &source);
+
+public:
+    SpriteAtlas();
+    ~SpriteAtlas();
+
+    // Load the remap table and its pages, false if there's no (valid) atlas
+    bool load(const char *path);
+
+    // Handle of a sprite sheet, sheets the atlas doesn't have are loaded on their own
+    int getSource(const std::string &image);
+
+    // Size of a sheet's original image
+    Vector2 getSourceSize(int source) const;
+
+    // Where a source rect of a sheet is drawn from (negative sizes flip, like DrawTexturePro)
+    AtlasSprite resolve(int source, Rectangle src);
+
+    // The whole original image of a sheet, for code that needs its grid layout
+    Texture2D getSourceTexture(int source);
+
+    int getPageCount() const;
+    int getFallbackCount() const;
+};
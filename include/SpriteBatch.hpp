@@ -0,0 +1,63 @@
+#pragma once
+#include "main.hpp"
+
+// Y-sorted sprite batcher
+//  - Sprites are queued as compact keys (quantized y-level, texture slot) pointing at their draw data
+//  - Keys are sorted with a stable LSD radix sort: sprites on the same y are grouped by texture slot,
+//    and only sprites sharing both y and texture keep submission order
+//  - Same-texture runs are submitted straight to rlgl as one quad batch instead of a draw call each
+class SpriteBatch
+{
+private:
+    struct Sprite
+    {
+        Rectangle source;
+        Vector2 position;
+        Color color;
+        int texture_slot;
+    };
+
+    // Sort key: quantized y-level in the high 24 bits, texture slot in the low 8
+    struct SpriteKey
+    {
+        uint32_t sort_key;
+        uint32_t sprite;
+    };
+
+    // Textures seen so far, sprites refer to them by slot
+    std::vector<Texture2D> textures;
+    int last_texture_slot;
+
+    // Sprites past the 256 slots a frame can use are dropped, with one warning
+    bool warned_slots_full;
+
+    std::vector<Sprite> sprites;
+    std::vector<SpriteKey> keys;
+
+    // Ping-pong buffer for the radix passes
+    std::vector<SpriteKey> keys_scratch;
+
+    // Slot of a texture, -1 if every slot is taken this frame
+    int getTextureSlot(Texture2D tex);
+
+    void drawRun(int texture_slot, const SpriteKey *run_keys, int count);
+
+public:
+    SpriteBatch(int capacity);
+
+    // Make room for capacity sprites up front, add() never allocates below it
+    void reserve(int capacity);
+
+    // Drop last frame's sprites (keeps capacity and the texture slots)
+    void clear();
+
+    void add(Texture2D tex, Rectangle source, Vector2 position, Color color, float y_level);
+
+    // Order the queued sprites by y-level, then texture
+    void sort();
+
+    // Sort and draw every queued sprite
+    void draw();
+
+    int getSpriteCount() const;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include "main.hpp"
+
+// Scoped trace zones, exported as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+//  - Each thread records into its own fixed ring buffer, no locks or allocations on the hot path
+//  - Once a ring is full the oldest zones are overwritten, so a flush holds the last few seconds
+//  - Only compiled in when PLT_TRACE is defined (every config but Release/MinSizeRel), otherwise
+//    TRACE_ZONE expands to nothing
+//
+// Usage:
+//      TRACE_THREAD_NAME("main");      // label the calling thread, others are "worker"
+//      TRACE_ZONE("App::runFrame");    // name must be a string literal, only the pointer is kept
+//      TRACE_FLUSH("trace.json");      // write everything recorded so far
+
+#ifdef PLT_TRACE
+
+#include <atomic>
+#include <mutex>
+
+struct TraceEvent
+{
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+// One thread's zones. Written only by its owning thread, read by flushes
+struct TraceBuffer
+{
+    static const uint32_t capacity = 1 << 16;
+
+    int thread_index;
+
+    // Label in the trace viewer (a string literal), set with traceSetThreadName
+    const char *thread_name;
+
+    TraceEvent events[capacity];
+
+    // Total zones ever written, the ring slot is head % capacity
+    std::atomic<uint64_t> head;
+};
+
+// Nanoseconds since the trace epoch (first use)
+uint64_t traceNow();
+
+// Label the calling thread's zones, name must be a string literal
+void traceSetThreadName(const char *name);
+
+// Record a finished zone on the calling thread
+void traceRecord(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+// Write every thread's ring buffer to path, returns false if the file couldn't be opened
+bool traceFlush(const char *path);
+
+class TraceZone
+{
+private:
+    const char *name;
+    uint64_t start_ns;
+
+public:
+    TraceZone(const char *name)
+    {
+        this->name = name;
+        start_ns = traceNow();
+    }
+
+    ~TraceZone()
+    {
+        traceRecord(name, start_ns, traceNow());
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) traceSetThreadName(name)
+#define TRACE_FLUSH(path) traceFlush(path)
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_FLUSH(path) ((void)0)
+
+#endif
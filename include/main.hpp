@@ -7,9 +7,22 @@
 // Configure:
 //      emcmake cmake .. -DPLATFORM=Web -DCMAKE_BUILD_TYPE=Release "-DCMAKE_EXE_LINKER_FLAGS=-s USE_GLFW=3" -DCMAKE_EXECUTABLE_SUFFIX=".html"
 
-// Build:
+// Configure (native desktop, for profiling):
+//      cmake .. -DCMAKE_BUILD_TYPE=RelWithDebInfo
+//      cmake --build . && cd <assets dir> && <build dir>/SpeedJam5 --uncapped --no-vsync --frames 2000
+
+// Build (bakes the map and packs the atlas into assets/ first, Web builds compile the tools for the host):
 //      cmake --build .
 
+// Bake the map on its own (output lands in assets/):
+//      cmake --build . --target bake_map
+
+// Pack the sprite atlas on its own (same, after changing a sprite sheet, the food catalog or the map):
+//      cmake --build . --target pack_atlas
+
+// Check that rendering a day doesn't allocate (native Debug build, needs a display):
+//      ctest --output-on-failure
+
 // Host (select the new HTML5 file):
 //      python -m http.server 8888 --bind 0.0.0.0
 //
@@ -23,10 +36,15 @@
 #include <memory>
 #include <stdio.h>
 #include <map>
+#include <unordered_map>
 #include <filesystem>
 #include <random>
 #include <sstream>
 #include <queue>
+#include <chrono>
+#include <thread>
+#include <string.h>
+#include <assert.h>
 
 // Graphics
 #include "raylib.h"
@@ -37,7 +55,9 @@
 #include "flecs.h"
 
 // Emscripten
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#endif
 
 // Tiled loader
 #include "cute_tiled.h"
@@ -48,10 +68,36 @@
 // Easing
 #include "easing.h"
 
+// Baked map format
+#include "MapFormat.hpp"
+
+// Packed sprite atlas format
+#include "AtlasFormat.hpp"
+
+// Ingredient and dish catalog
+#include "FoodCatalog.hpp"
+
 // Custom files
 class Map;
 class App;
+class SpatialGrid;
+class SpriteBatch;
+class SpriteAtlas;
+class FrameArena;
+class Profiler;
+class InputLog;
+class ItemPool;
 
 #include "Components.hpp"
+#include "SpatialGrid.hpp"
+#include "Random.hpp"
+#include "SpriteBatch.hpp"
+#include "SpriteAtlas.hpp"
+#include "FrameArena.hpp"
+#include "AllocCounter.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include "InputLog.hpp"
+#include "ItemPool.hpp"
 #include "Map.hpp"
 #include "App.hpp"
\ No newline at end of file
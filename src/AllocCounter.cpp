@@ -0,0 +1,61 @@
+#include "AllocCounter.hpp"
+
+#ifdef PLT_COUNT_ALLOCS
+
+#include <atomic>
+#include <new>
+
+static std::atomic<uint64_t> alloc_count(0);
+
+uint64_t getAllocCount()
+{
+    return alloc_count.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *ptr = malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+#endif
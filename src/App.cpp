@@ -34,11 +34,6 @@ int pointInAABB(c2AABB A, c2v B)
     return !(d0 | d1 | d2 | d3);
 }
 
-bool compSPR(plt::SPR i, plt::SPR j)
-{
-    return (i.y_level < j.y_level);
-}
-
 c2AABB rectToAABB(Rectangle rec)
 {
     return c2AABB{rec.x, rec.y, rec.x + rec.width, rec.y + rec.height};
@@ -59,45 +54,73 @@ void setGuiTextStyle(Font f, int color, int h_align, int v_align, int size, int
     GuiSetStyle(DEFAULT, TEXT_LINE_SPACING, spacing);
 }
 
+// Scripted input for headless runs: start the game, skip the dialogue, then wander
+// around the kitchen poking stations and picking menu options
+plt::InputState App::getScriptedInput(int tick, int sim_hz)
+{
+    plt::InputState input = {};
+    input.menu_select = plt::MenuSelect_None;
+
+    // Change what we're doing twice a second
+    int step = tick / (sim_hz / 2);
+
+    input.advance = tick % 2 == 0;
+    input.interact = step % 3 == 0;
+
+    switch (step % 4)
+    {
+    case 0:
+        input.up = true;
+        break;
+    case 1:
+        input.left = true;
+        break;
+    case 2:
+        input.down = true;
+        break;
+    case 3:
+        input.right = true;
+        break;
+    }
+
+    if (tick % sim_hz == 0)
+        input.menu_select = (step / 4) % 3 + 1;
+
+    return input;
+}
+
 // ==================================================
 // Order Functions
 // ==================================================
 void App::addDishToOrder(plt::Order &o, plt::Dish dish)
 {
-    o.dishes.push_back(dish);
-    o.indicies.push_back(std::make_pair(0, o.dishes.size() - 1));
+    assert(o.part_count < plt::Order_MaxParts);
+    o.parts[o.part_count++] = plt::makeItemKey(dish);
 }
 
 void App::addIngredientToOrder(plt::Order &o, plt::Ingredient ing)
 {
-    o.ingredients.push_back(ing);
-    o.indicies.push_back(std::make_pair(1, o.ingredients.size() - 1));
+    assert(o.part_count < plt::Order_MaxParts);
+    o.parts[o.part_count++] = plt::makeItemKey(ing);
 }
 
 plt::Order App::getRandomOrder(int number_of_sides)
 {
-    plt::Order f_order;
-    f_order.completion = 0;
-
-    std::random_device rd;  // obtain a random number from hardware
-    std::mt19937 gen(rd()); // seed the generator
+    plt::Order f_order = {};
 
-    std::uniform_int_distribution<> dishtype_dist(0, 1);
-    std::uniform_int_distribution<> filltype_dist(0, 4);
-
-    plt::DishType dish_type = (plt::DishType)(dishtype_dist(gen));
+    plt::DishType dish_type = (plt::DishType)(order_rng.range(2));
 
     plt::Dish dish;
     switch (dish_type)
     {
     case plt::DishType_Plate:
-        dish = dishes[1];
+        dish = {1, plt::BowlFillType_None};
         addDishToOrder(f_order, dish);
         break;
 
     case plt::DishType_Bowl:
-        dish = dishes[0];
-        dish.fill = (plt::BowlFillType)(filltype_dist(gen));
+        dish = {0, plt::BowlFillType_None};
+        dish.fill = (plt::BowlFillType)(order_rng.range(5));
         addDishToOrder(f_order, dish);
         break;
 
@@ -107,33 +130,41 @@ plt::Order App::getRandomOrder(int number_of_sides)
 
     for (int i = 0; i < number_of_sides; i++)
     {
-        plt::Ingredient new_ingredient = ingredients[rand() % ingredients.size()];
-        new_ingredient.state = (plt::IngredientState)(rand() % 3 + 1);
+        plt::Ingredient new_ingredient = {(uint16_t)order_rng.range(ingredient_prefabs.size()), plt::Whole};
+        new_ingredient.state = (plt::IngredientState)(order_rng.range(1, 3));
         addIngredientToOrder(f_order, new_ingredient);
     }
 
     return f_order;
 }
 
-void App::renderIngredient(plt::Ingredient &ing, Rectangle target, Color color)
+void App::drawSprite(int sheet, Rectangle src, Rectangle dest, Color color)
+{
+    AtlasSprite sprite = sprite_atlas->resolve(sheet, src);
+    DrawTexturePro(sprite.tex, sprite.src, dest, {0.f, 0.f}, 0, color);
+}
+
+void App::renderIngredient(const plt::Ingredient &ing, Rectangle target, Color color)
 {
-    DrawTexturePro(meals_tex, {ing.pos.x, ing.pos.y + 32.f * ing.state, 32, 32}, target, {0.f, 0.f}, 0, color);
+    Vector2 tex_pos = getIngredientInfo(ing.id).pos;
+    drawSprite(meals_sheet, {tex_pos.x, tex_pos.y + 32.f * ing.state, 32, 32}, target, color);
 }
 
 void App::renderDevil(Rectangle target, Color color)
 {
-    DrawTexturePro(devil_tex, {64.f * (devil.frame % 3), 64.f * (devil.frame / 3), 64, 64}, target, {0.f, 0.f}, 0, color);
+    drawSprite(devil_sheet, {64.f * (devil.frame % 3), 64.f * (devil.frame / 3), 64, 64}, target, color);
 }
 
-void App::renderDish(plt::Dish &dish, Rectangle target, Color color)
+void App::renderDish(const plt::Dish &dish, Rectangle target, Color color)
 {
-    DrawTexturePro(meals_tex, {dish.pos.x, dish.pos.y, 32, 32}, target, {0.f, 0.f}, 0, WHITE);
+    Vector2 tex_pos = getDishInfo(dish.id).pos;
+    drawSprite(meals_sheet, {tex_pos.x, tex_pos.y, 32, 32}, target, WHITE);
 
     // Draw Fill
     if (dish.fill != plt::BowlFillType_None)
     {
         int fill_int = ((int)dish.fill) - 1;
-        DrawTexturePro(meals_tex, {bowl_fills[fill_int].x, bowl_fills[fill_int].y, 32, 32}, target, {0.f, 0.f}, 0, WHITE);
+        drawSprite(meals_sheet, {bowl_fills[fill_int].x, bowl_fills[fill_int].y, 32, 32}, target, WHITE);
     }
 }
 
@@ -154,18 +185,18 @@ void App::renderIngredientInstr(plt::Ingredient &ing, Vector2 pt, bool done)
 
     renderIngredient(ing, sprite_area, WHITE);
 
-    std::string desc_str = ing.name + "\n";
+    const char *state_str = "";
 
     switch (ing.state)
     {
     case plt::LeftPile:
-        desc_str += "Left Cut";
+        state_str = "Left Cut";
         break;
     case plt::CenterPile:
-        desc_str += "Middle Cut";
+        state_str = "Middle Cut";
         break;
     case plt::RightPile:
-        desc_str += "Right Cut";
+        state_str = "Right Cut";
         break;
 
     default:
@@ -173,7 +204,7 @@ void App::renderIngredientInstr(plt::Ingredient &ing, Vector2 pt, bool done)
     }
 
     setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_LEFT, TEXT_ALIGN_MIDDLE, 23, 17);
-    GuiLabel(Rectangle{sprite_area.x + 40, sprite_area.y + 5, 192 - 40, 40}, desc_str.c_str());
+    GuiLabel(Rectangle{sprite_area.x + 40, sprite_area.y + 5, 192 - 40, 40}, frame_arena->format("%s\n%s", getIngredientInfo(ing.id).name.c_str(), state_str));
 }
 
 void App::renderDishInstr(plt::Dish &dish, Vector2 pt, bool done)
@@ -193,128 +224,175 @@ void App::renderDishInstr(plt::Dish &dish, Vector2 pt, bool done)
 
     renderDish(dish, sprite_area, WHITE);
 
-    std::string desc_str = dish.name + "\n";
+    const char *fill_str = "";
     switch (dish.fill)
     {
     case plt::BowlFillType_None:
-        desc_str += "No Fill";
+        fill_str = "No Fill";
         break;
     case plt::BowlFillType_Red:
-        desc_str += "Red Fill";
+        fill_str = "Red Fill";
         break;
     case plt::BowlFillType_Yellow:
-        desc_str += "Yellow Fill";
+        fill_str = "Yellow Fill";
         break;
     case plt::BowlFillType_Green:
-        desc_str += "Green Fill";
+        fill_str = "Green Fill";
         break;
     case plt::BowlFillType_Brown:
-        desc_str += "Brown Fill";
+        fill_str = "Brown Fill";
         break;
 
     default:
         break;
     }
     setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_LEFT, TEXT_ALIGN_MIDDLE, 23, 17);
-    GuiLabel(Rectangle{sprite_area.x + 40, sprite_area.y + 5, 192 - 40, 40}, desc_str.c_str());
+    GuiLabel(Rectangle{sprite_area.x + 40, sprite_area.y + 5, 192 - 40, 40}, frame_arena->format("%s\n%s", getDishInfo(dish.id).name.c_str(), fill_str));
 }
 
 void App::renderOrderInstr(plt::Order &order)
 {
-    for (int part = 0; part < order.indicies.size(); part++)
+    for (int part = 0; part < order.part_count; part++)
     {
+        plt::ItemKey key = order.parts[part];
+
         // Dish
-        if (order.indicies[part].first == 0)
-            renderDishInstr(order.dishes[order.indicies[part].second], {432.f, part * 40.f}, part < order.completion);
+        if (plt::getItemKind(key) == plt::ItemKind_Dish)
+        {
+            plt::Dish dish = plt::getItemDish(key);
+            renderDishInstr(dish, {432.f, part * 40.f}, part < order.completion);
+        }
         else
-            renderIngredientInstr(order.ingredients[order.indicies[part].second], {432.f, part * 40.f}, part < order.completion);
+        {
+            plt::Ingredient ing = plt::getItemIngredient(key);
+            renderIngredientInstr(ing, {432.f, part * 40.f}, part < order.completion);
+        }
     }
 }
 
-bool App::areIngredientsEqual(plt::Ingredient &a, plt::Ingredient &b)
-{
-    return a.name == b.name && a.state == b.state;
-}
-
-bool App::areDishesEqual(plt::Dish &a, plt::Dish &b)
-{
-    return a.name == b.name && a.type == b.type && a.fill == b.fill;
-}
-
 void App::addRandomCustomers(int count, int order_size)
 {
     for (int i = 0; i < count; i++)
     {
         plt::Customer new_customer;
-        new_customer.type = (plt::CustomerType)(rand() % (plt::CustomerType_Built + 1));
+        new_customer.type = (plt::CustomerType)(customer_rng.range(plt::CustomerType_Built + 1));
         new_customer.state = plt::CustomerState_InLine;
-        new_customer.col = Color{(unsigned char)(rand() % 256), (unsigned char)(rand() % 256), (unsigned char)(rand() % 256), (unsigned char)(204)};
+        new_customer.col = Color{(unsigned char)customer_rng.range(256), (unsigned char)customer_rng.range(256), (unsigned char)customer_rng.range(256), (unsigned char)(204)};
         new_customer.order = getRandomOrder(order_size);
         new_customer.pos = {6 * 32, 12 * 32};
+        new_customer.prev_pos = new_customer.pos;
         customers.push_back(new_customer);
     }
 }
 
-bool App::isPlayerHoldingRightPiece(plt::Player &player, plt::Order &order)
+bool App::isPlayerHoldingRightPiece(const plt::HeldItem &held, plt::Order &order)
 {
-    if (player.holding_type == plt::PlayerHoldingType_None)
+    if (!held.entity)
         return false;
 
-    // Get the item the player is currently holding
-    flecs::entity player_item_e = ecs_world->get_alive(player.item);
+    // Get the item required, identity (kind, catalog id, state/fill) is packed so matching is one compare
+    if (order.completion >= order.part_count)
+        return false;
 
-    // Get the item required
-    int order_needed_type = order.indicies[order.completion].first;
-    int order_index = order.indicies[order.completion].second;
+    plt::ItemKey needed = order.parts[order.completion];
 
-    switch (order_needed_type)
-    {
-    case 0: // Dishes
-    {
-        if (!player_item_e.has<plt::Dish>())
-            return false;
+    if (held.dish)
+        return plt::makeItemKey(*held.dish) == needed;
 
-        plt::Dish *player_dish = player_item_e.get_mut<plt::Dish>();
-        return areDishesEqual(*player_dish, order.dishes[order_index]);
-    }
-    break;
-    case 1: // Ingredients
-    {
-        if (!player_item_e.has<plt::Ingredient>())
-            return false;
+    if (held.ing)
+        return plt::makeItemKey(*held.ing) == needed;
 
-        plt::Ingredient *player_ing = player_item_e.get_mut<plt::Ingredient>();
-        return areIngredientsEqual(*player_ing, order.ingredients[order_index]);
-    }
-    break;
+    return false;
+}
 
-    default:
-        break;
-    }
+plt::HeldItem App::getHeldItem(flecs::entity player_e, const plt::Player &player)
+{
+    plt::HeldItem held = {};
 
-    return false;
+    if (player.holding_type == plt::PlayerHoldingType_None)
+        return held;
+
+    // $this is always variable 0, $item and its components come back from the same match
+    held_item_r.iter()
+        .set_var(0, player_e)
+        .iter([&](flecs::iter &it)
+              {
+                  held.entity = it.get_var(held_item_var);
+
+                  if (it.is_set(2))
+                      held.ing = &*it.field<const plt::Ingredient>(2);
+
+                  if (it.is_set(3))
+                      held.dish = &*it.field<const plt::Dish>(3); //
+              });
+
+    return held;
+}
+
+void App::holdItem(flecs::entity player_e, plt::Player &player, flecs::entity item, plt::PlayerHoldingType type)
+{
+    player_e.add<plt::Holds>(item);
+    player.holding_type = type;
+}
+
+void App::releaseHeldItem(flecs::entity player_e, plt::Player &player, const plt::HeldItem &held)
+{
+    item_pool->release(held.entity);
+
+    player_e.remove<plt::Holds>(flecs::Wildcard);
+    player.holding_type = plt::PlayerHoldingType_None;
 }
 
 // ==================================================
 // App
 // ==================================================
-App::App(int screen_w, int screen_h)
+App::App(int screen_w, int screen_h, int sim_hz, bool headless, uint64_t seed)
 {
     // Set screen w and h
     this->screen_w = screen_w;
     this->screen_h = screen_h;
 
+    this->headless = headless;
+
+    // Every random draw comes from a stream of this seed, so a seed reproduces a run exactly
+    this->seed = seed;
+    order_rng.reseed(seed, 1);
+    customer_rng.reseed(seed, 2);
+
     time_counter = 0;
 
+    assert(sim_hz >= App_MinSimHz && sim_hz <= App_MaxSimHz);
+    sim_step = 1.f / sim_hz;
+    sim_accumulator = 0;
+    sim_alpha = 0;
+
+    frame_input = {};
+    frame_input.menu_select = plt::MenuSelect_None;
+    tick_input = frame_input;
+    pending_menu_select = plt::MenuSelect_None;
+
     devil = {0, 9, 0.f, 0.1f};
 
     render_colliders = false;
     render_positions = false;
 
+    profiler = std::make_unique<Profiler>(240);
+
+    sprite_batch = std::make_unique<SpriteBatch>(1024);
+    frame_arena = std::make_unique<FrameArena>(16 * 1024);
+
+    render_game_state = plt::GameState_MainMenu;
+    render_state_frames = 0;
+    render_frame_allocs = 0;
+    render_alloc_warned = false;
+
     is_audio_initialized = false;
 
-    lookout_font = LoadFontEx("fonts/Lookout 7.ttf", 128, 0, 250);
-    fear_font = LoadFontEx("fonts/Fear 11.ttf", 128, 0, 250);
+    if (!headless)
+    {
+        lookout_font = LoadFontEx("fonts/Lookout 7.ttf", 128, 0, 250);
+        fear_font = LoadFontEx("fonts/Fear 11.ttf", 128, 0, 250);
+    }
 
     inv_rot = {0.0, 20, 20, true, -1, 1, EaseInOutCubic};
     inv_scale = {0.0, 10, 10, true, 0.1, 0.3, EaseInOutCubic};
@@ -327,162 +405,185 @@ App::App(int screen_w, int screen_h)
     // Initialize ECS World
     // ==================================================
     ecs_world = std::make_unique<flecs::world>();
+    solid_grid = std::make_unique<SpatialGrid>(64.f);
+    nearby_solids.resize(1);
+    item_pool = std::make_unique<ItemPool>();
     initSystems();
 
     // ==================================================
-    // Initialize the Map
+    // Load the sprite atlas (nothing is drawn when headless)
+    //  - Sheets missing from it (or no atlas at all) load as separate textures
     // ==================================================
-    map = std::make_unique<Map>(ecs_world.get());
+    if (!headless)
+    {
+        sprite_atlas = std::make_unique<SpriteAtlas>();
+
+        if (!sprite_atlas->load("atlas.bin"))
+            TraceLog(LOG_INFO, "ATLAS: no atlas.bin, drawing from the separate textures");
+
+        player_sheet = sprite_atlas->getSource("chef_ghost_strip.png");
+        meals_sheet = sprite_atlas->getSource(plt::FoodCatalog_Image);
+        customer_sheet = sprite_atlas->getSource("customers.png");
+        logo_sheet = sprite_atlas->getSource("Am_I_cooked.png");
+        devil_sheet = sprite_atlas->getSource("Fire 64x.png");
+        outro_sheet = sprite_atlas->getSource("not_cooked.png");
+    }
 
     // ==================================================
-    // Load textures
+    // Initialize the Map
     // ==================================================
+    map = std::make_unique<Map>(ecs_world.get(), headless, sprite_atlas.get());
 
-    // Load the player texture
-    {
-        Image player_img = LoadImage("chef_ghost_strip.png");
-        player_tex = LoadTextureFromImage(player_img);
-        UnloadImage(player_img);
-    }
-    // Load the food texture
-    {
-        Image meals_img = LoadImage("meals.png");
-        meals_tex = LoadTextureFromImage(meals_img);
-        UnloadImage(meals_img);
-    }
-    // Load the customer texture
-    {
-        Image cust_img = LoadImage("customers.png");
-        customer_tex = LoadTextureFromImage(cust_img);
-        UnloadImage(cust_img);
-    }
-    // Load the customer texture
-    {
-        Image logo_img = LoadImage("Am_I_cooked.png");
-        logo_tex = LoadTextureFromImage(logo_img);
-        UnloadImage(logo_img);
-    }
-    // Load the devil texture
-    {
-        Image devil_img = LoadImage("Fire 64x.png");
-        devil_tex = LoadTextureFromImage(devil_img);
-        UnloadImage(devil_img);
-    }
-    // Load the outro texture
-    {
-        Image outro_img = LoadImage("not_cooked.png");
-        outro_tex = LoadTextureFromImage(outro_img);
-        UnloadImage(outro_img);
-    }
+    // Bake the chunks on screen now rather than on the first frame
+    map->prefetch(Rectangle{0, 0, (float)screen_w, (float)screen_h});
 
     initFood();
 }
 
 App::~App()
 {
-    UnloadTexture(player_tex);
-    UnloadTexture(meals_tex);
-
     for (auto &track : game_music)
         UnloadMusicStream(track);
 }
 
 void App::initSystems()
 {
+    // A player holds at most one item
+    ecs_world->component<plt::Holds>().add(flecs::Exclusive);
+
+    // Cached queries used by the systems, matched against tables once instead of every frame
+    cooking_zone_q = ecs_world->query<plt::CookingZone>();
+    player_q = ecs_world->query<plt::Position, plt::Player>();
+    collider_q = ecs_world->query<plt::Position, plt::Collider>();
+    position_q = ecs_world->query<plt::Position>();
+    player_sprite_q = ecs_world->query<plt::Position, plt::PrevPosition, plt::Player>();
+
+    // Rules aren't cached like queries, but the compiled plan is reused for every lookup
+    held_item_r = ecs_world->rule_builder()
+                      .with<plt::Holds>("$item")
+                      .with<plt::Ingredient>().src("$item").in().optional()
+                      .with<plt::Dish>().src("$item").in().optional()
+                      .build();
+    held_item_var = held_item_r.find_var("item");
+
+    // Simulation systems are stepped at a fixed rate, rendering once per frame (see runFrame)
+    sim_pipeline = ecs_world->pipeline()
+                       .with(flecs::System)
+                       .with<plt::SimulationPhase>()
+                       .build();
+
+    render_pipeline = ecs_world->pipeline()
+                          .with(flecs::System)
+                          .with<plt::RenderPhase>()
+                          .build();
+
+    // Systems that only touch their own entity's components (and read the broadphase) are multi_threaded,
+    // with setThreadCount(n) their entities are split over the workers. Everything else stays on the main thread
+    flecs::system snapshot_system = ecs_world->system<plt::Position, plt::PrevPosition>()
+                                        .kind<plt::SimulationPhase>()
+                                        .multi_threaded()
+                                        .iter([&](flecs::iter &it, plt::Position *pos, plt::PrevPosition *prev)
+                                              {
+                                                  TRACE_ZONE("SnapshotSystem");
+                                                  Profiler::Scope scope(profiler.get(), ProfileSlot_Snapshot, it.world().get_stage_id());
+                                                  for (auto i : it)
+                                                      SnapshotSystem(it.entity(i), pos[i], prev[i]); //
+                                              });
+
+    // Timed systems iterate per table so the profiler scope wraps a whole batch, not each entity
     flecs::system player_system = ecs_world->system<plt::Position, plt::Player>()
-                                      .kind(flecs::PreUpdate)
-                                      .each([&](flecs::entity e, plt::Position &pos, plt::Player &player)
+                                      .kind<plt::SimulationPhase>()
+                                      .iter([&](flecs::iter &it, plt::Position *pos, plt::Player *player)
                                             {
-                                                PlayerSystem(e, pos, player); //
+                                                TRACE_ZONE("PlayerSystem");
+                                                Profiler::Scope scope(profiler.get(), ProfileSlot_Player);
+                                                for (auto i : it)
+                                                    PlayerSystem(it.entity(i), pos[i], player[i]); //
                                             });
 
+    // Every stage times its own share into its own row of the profiler, the overlay shows their sum
     flecs::system collision_system = ecs_world->system<plt::Position, plt::Collider>()
-                                         .kind(flecs::PreUpdate)
-                                         .each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll)
+                                         .kind<plt::SimulationPhase>()
+                                         .multi_threaded()
+                                         .iter([&](flecs::iter &it, plt::Position *pos, plt::Collider *coll)
                                                {
-                                                   CollisionSystem(e, pos, coll); //
+                                                   TRACE_ZONE("CollisionSystem");
+                                                   Profiler::Scope scope(profiler.get(), ProfileSlot_Collision, it.world().get_stage_id());
+                                                   for (auto i : it)
+                                                       CollisionSystem(it.entity(i), pos[i], coll[i]); //
                                                });
 
     flecs::system dynamic_body_system = ecs_world->system<plt::Position, plt::Collider, plt::DynamicBody>()
-                                            .kind(flecs::PreUpdate)
-                                            .each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll, plt::DynamicBody &dyn)
+                                            .kind<plt::SimulationPhase>()
+                                            .multi_threaded()
+                                            .iter([&](flecs::iter &it, plt::Position *pos, plt::Collider *coll, plt::DynamicBody *dyn)
                                                   {
-                                                      DynamicBodySystem(e, pos, coll); //
+                                                      TRACE_ZONE("DynamicBodySystem");
+                                                      int stage = it.world().get_stage_id();
+                                                      Profiler::Scope scope(profiler.get(), ProfileSlot_DynamicBody, stage);
+                                                      for (auto i : it)
+                                                          DynamicBodySystem(it.entity(i), pos[i], coll[i], stage); //
                                                   });
 
+    // Solid bodies enter the broadphase when they're set up, and only move in it when their position is set again
+    ecs_world->observer<plt::Position, plt::Collider, plt::SolidBody>()
+        .event(flecs::OnSet)
+        .each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll, plt::SolidBody &sol)
+              {
+                  solid_grid->insert(e.id(), rectToAABB({pos.x + coll.bounds.x, pos.y + coll.bounds.y, coll.bounds.width, coll.bounds.height})); //
+              });
+
+    ecs_world->observer<plt::SolidBody>()
+        .event(flecs::OnRemove)
+        .each([&](flecs::entity e, plt::SolidBody &sol)
+              {
+                  solid_grid->remove(e.id()); //
+              });
+
     flecs::system customer_system = ecs_world->system()
-                                        .kind(flecs::PreUpdate)
+                                        .kind<plt::SimulationPhase>()
                                         .iter([&](flecs::iter &it)
                                               {
+                                                  TRACE_ZONE("CustomerSystem");
+                                                  Profiler::Scope scope(profiler.get(), ProfileSlot_Customer);
                                                   CustomerSystem(); //
                                               });
 
+    flecs::system game_state_system = ecs_world->system()
+                                          .kind<plt::SimulationPhase>()
+                                          .iter([&](flecs::iter &it)
+                                                {
+                                                    TRACE_ZONE("GameStateSystem");
+                                                    Profiler::Scope scope(profiler.get(), ProfileSlot_GameState);
+                                                    GameStateSystem(); //
+                                                });
+
+    // Nothing to render to when headless
+    if (headless)
+        return;
+
     flecs::system render_system = ecs_world->system()
-                                      .kind(flecs::PostUpdate)
+                                      .kind<plt::RenderPhase>()
                                       .iter([&](flecs::iter &it)
                                             {
+                                                TRACE_ZONE("RenderSystem");
                                                 RenderSystem(); //
                                             });
 }
 
 void App::initFood()
 {
-    // Vegetables
-    ingredients.push_back({"Melon", {0, 64}, false, plt::Whole});
-    ingredients.push_back({"Carrot", {32, 64}, false, plt::Whole});
-    ingredients.push_back({"White Carrot", {64, 64}, false, plt::Whole});
-    ingredients.push_back({"Potato", {128, 64}, false, plt::Whole});
-    ingredients.push_back({"Yam", {224, 64}, false, plt::Whole});
-    ingredients.push_back({"Purple Yam", {320, 64}, false, plt::Whole});
-    ingredients.push_back({"Tomato", {384, 64}, false, plt::Whole});
-
-    ingredients.push_back({"Chicken Leg", {0, 512}, true, plt::Whole});
-    ingredients.push_back({"Sausage", {64, 512}, true, plt::Whole});
-
-    ingredients.push_back({"Corn", {448, 64}, false, plt::Whole});
-    ingredients.push_back({"Onion", {480, 64}, false, plt::Whole});
-    ingredients.push_back({"Red Onion", {512, 64}, false, plt::Whole});
-    ingredients.push_back({"Purple Onion", {544, 64}, false, plt::Whole});
-    ingredients.push_back({"Green Pepper", {576, 64}, false, plt::Whole});
-    ingredients.push_back({"Red Pepper", {608, 64}, false, plt::Whole});
-    ingredients.push_back({"Orange Pepper", {640, 64}, false, plt::Whole});
-
-    ingredients.push_back({"Bacon", {96, 512}, true, plt::Whole});
-    ingredients.push_back({"Flank", {128, 512}, true, plt::Whole});
-
-    ingredients.push_back({"Yellow Pepper", {672, 64}, false, plt::Whole});
-    ingredients.push_back({"Brussel Sprouts", {736, 64}, false, plt::Whole});
-    ingredients.push_back({"Cauliflower", {768, 64}, false, plt::Whole});
-    ingredients.push_back({"Broccoli", {800, 64}, false, plt::Whole});
-    ingredients.push_back({"Squash", {864, 64}, false, plt::Whole});
-    ingredients.push_back({"Cucumber", {896, 64}, false, plt::Whole});
-    ingredients.push_back({"Radish", {928, 64}, false, plt::Whole});
-
-    ingredients.push_back({"Meatballs", {160, 512}, true, plt::Whole});
-    ingredients.push_back({"Steak", {224, 512}, true, plt::Whole});
-
-    ingredients.push_back({"Turnip", {960, 64}, false, plt::Whole});
-    ingredients.push_back({"Apple", {800, 512}, false, plt::Whole});
-    ingredients.push_back({"Orange", {832, 512}, false, plt::Whole});
-    ingredients.push_back({"Pineapple", {896, 512}, false, plt::Whole});
-    ingredients.push_back({"Strawberry", {928, 512}, false, plt::Whole});
-    ingredients.push_back({"Kiwi", {992, 512}, false, plt::Whole});
-
-    // Bowls
-    // dishes.push_back({"Small Bowl", plt::DishType_Bowl, {0, 0}, plt::BowlFillType_None});
-    // dishes.push_back({"Medium Bowl", plt::DishType_Bowl, {32, 0}, plt::BowlFillType_None});
-    dishes.push_back({"Large Bowl", plt::DishType_Bowl, {64, 0}, plt::BowlFillType_None});
-
-    // Plates
-    // dishes.push_back({"Small Plate", plt::DishType_Plate, {96, 0}, plt::BowlFillType_None});
-    // dishes.push_back({"Medium Plate", plt::DishType_Plate, {128, 0}, plt::BowlFillType_None});
-    dishes.push_back({"Large Plate", plt::DishType_Plate, {160, 0}, plt::BowlFillType_None});
-
-    // Fills
-    bowl_fills.push_back(Vector2{128, 32});
-    bowl_fills.push_back(Vector2{192, 32});
-    bowl_fills.push_back(Vector2{256, 32});
-    bowl_fills.push_back(Vector2{320, 32});
+    // The catalog tables are shared with the atlas packer (FoodCatalog.hpp)
+    static_assert(plt::FoodCatalog_StateRows == plt::BottomKebab + 1, "meals.png has one row per IngredientState");
+
+    for (auto &def : plt::ingredient_defs)
+        addIngredientPrefab(def.name, {def.x, def.y}, def.cookable);
+
+    for (auto &def : plt::dish_defs)
+        addDishPrefab(def.name, (plt::DishType)def.type, {def.x, def.y});
+
+    for (auto &cell : plt::bowl_fill_cells)
+        bowl_fills.push_back(Vector2{cell.x, cell.y});
 
     Day3Dialogue.push_back("ORGAN TIME!!");
     Day3Dialogue.push_back("HA HA HA HA...");
@@ -514,15 +615,237 @@ void App::initFood()
     Day1Dialogue.push_back("Look who just fell down\n...press [SPACE] to continue...");
 }
 
+void App::addIngredientPrefab(const char *name, Vector2 pos, bool cookable)
+{
+    flecs::entity prefab = ecs_world->prefab();
+    prefab.set<plt::IngredientInfo>({name, pos, cookable});
+
+    ingredient_prefabs.push_back(prefab.id());
+}
+
+void App::addDishPrefab(const char *name, plt::DishType type, Vector2 pos)
+{
+    flecs::entity prefab = ecs_world->prefab();
+    prefab.set<plt::DishInfo>({name, type, pos});
+
+    dish_prefabs.push_back(prefab.id());
+}
+
+const plt::IngredientInfo &App::getIngredientInfo(int id)
+{
+    return *ecs_world->entity(ingredient_prefabs[id]).get<plt::IngredientInfo>();
+}
+
+const plt::DishInfo &App::getDishInfo(int id)
+{
+    return *ecs_world->entity(dish_prefabs[id]).get<plt::DishInfo>();
+}
+
+void App::applyMenuSelection(flecs::entity e, plt::Player &player, const plt::HeldItem &held, int select)
+{
+    if (select == plt::MenuSelect_Exit)
+    {
+        player.cooking_zone = plt::CookingZone_None;
+        return;
+    }
+
+    switch (player.cooking_zone)
+    {
+    // Pick an ingredient out of the bag
+    case plt::CookingZone_Bag:
+    {
+        if (select < 0 || select >= ingredient_prefabs.size())
+            return;
+
+        flecs::entity ing_e = item_pool->acquireIngredient(e.world(), ingredient_prefabs[select], {(uint16_t)select, plt::Whole});
+        holdItem(e, player, ing_e, plt::PlayerHoldingType_Ingredient);
+    }
+    break;
+
+    // Pick a dish out of the cabinet
+    case plt::CookingZone_Dishes:
+    {
+        if (select < 0 || select >= dish_prefabs.size())
+            return;
+
+        flecs::entity dish_e = item_pool->acquireDish(e.world(), dish_prefabs[select], {(uint16_t)select, plt::BowlFillType_None});
+        holdItem(e, player, dish_e, plt::PlayerHoldingType_Dish);
+    }
+    break;
+
+    // Fill the held bowl
+    case plt::CookingZone_Sink:
+    {
+        if (select < 0 || select >= bowl_fills.size() || !held.dish)
+            return;
+
+        held.entity.get_mut<plt::Dish>()->fill = (plt::BowlFillType)(select + 1);
+    }
+    break;
+
+    // Cut or cook the held ingredient, the option is the resulting state
+    case plt::CookingZone_CuttingBoard:
+    case plt::CookingZone_Stove:
+    {
+        if (select < plt::LeftPile || select >= plt::SingleKebab || !held.ing)
+            return;
+
+        held.entity.get_mut<plt::Ingredient>()->state = (plt::IngredientState)select;
+    }
+    break;
+
+    default:
+        return;
+    }
+
+    player.cooking_zone = plt::CookingZone_None;
+}
+
 void App::runFrame()
 {
-    ecs_world->progress();
+    TRACE_ZONE("App::runFrame");
+
+    pollInput();
+
+    if (IsKeyPressed(KEY_F3))
+        profiler->toggle();
+
+    // Dump the last few seconds of trace zones (no-op when tracing is compiled out)
+    if (IsKeyPressed(KEY_F4))
+        TRACE_FLUSH("speedjam5_trace.json");
+
+    // Clamp long frames (breakpoints, tab switches) so the simulation doesn't spiral trying to catch up
+    const float max_frame_time = 0.25f;
+    float frame_time = std::min(GetFrameTime(), max_frame_time);
+
+    sim_accumulator += frame_time;
+
+    // Step the simulation in fixed increments, independent of the render rate
+    while (sim_accumulator >= sim_step)
+    {
+        stepSimulation();
+        sim_accumulator -= sim_step;
+    }
+
+    sim_alpha = sim_accumulator / sim_step;
+
+    // Render once, interpolating between the last two simulation states
+    ecs_world->frame_begin(frame_time);
+    ecs_world->run_pipeline(render_pipeline, frame_time);
+    ecs_world->frame_end();
+
+    profiler->endFrame(frame_time, *ecs_world);
+}
+
+void App::stepSimulation()
+{
+    tick_input = frame_input;
+
+    // One-shot inputs only count for the first tick that sees them
+    frame_input.advance = false;
+    frame_input.menu_select = plt::MenuSelect_None;
+
+    if (input_recording)
+        input_recording->record(tick_input);
+
+    ecs_world->frame_begin(sim_step);
+    ecs_world->run_pipeline(sim_pipeline, sim_step);
+    ecs_world->frame_end();
+}
+
+void App::stepHeadless(const plt::InputState &input)
+{
+    frame_input = input;
+    stepSimulation();
+}
+
+void App::startRecording()
+{
+    input_recording = std::make_unique<InputLog>(seed, (int)std::lround(1.f / sim_step));
+}
+
+bool App::saveRecording(const char *path)
+{
+    if (!input_recording)
+        return false;
+
+    return input_recording->save(path);
+}
+
+void App::pollInput()
+{
+    frame_input.up = IsKeyDown(KEY_W);
+    frame_input.down = IsKeyDown(KEY_S);
+    frame_input.left = IsKeyDown(KEY_A);
+    frame_input.right = IsKeyDown(KEY_D);
+    frame_input.interact = IsKeyDown(KEY_E);
+
+    // Presses are kept until a tick consumes them, even on frames without one
+    frame_input.advance = frame_input.advance || IsKeyPressed(KEY_SPACE);
+
+    frame_input.mouse = GetMousePosition();
+    frame_input.mouse_left = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+
+    if (pending_menu_select != plt::MenuSelect_None)
+    {
+        frame_input.menu_select = pending_menu_select;
+        pending_menu_select = plt::MenuSelect_None;
+    }
+}
+
+plt::GameState App::getGameState()
+{
+    return game_state;
+}
+
+float App::getTimeCounter()
+{
+    return time_counter;
+}
+
+uint64_t App::getSeed()
+{
+    return seed;
+}
+
+bool App::setMapRenderMode(MapRenderMode mode)
+{
+    return map->setRenderMode(mode);
+}
+
+void App::setThreadCount(int n)
+{
+    n = std::max(n, 1);
+
+    // flecs runs the main thread as stage 0 and starts n - 1 workers, each stage gets its own scratch
+    ecs_world->set_threads(n);
+    nearby_solids.resize(n);
+    profiler->setStageCount(n);
+}
+
+int App::getCustomerCount()
+{
+    return customers.size();
+}
+
+void App::SnapshotSystem(flecs::entity e, plt::Position &pos, plt::PrevPosition &prev)
+{
+    prev.x = pos.x;
+    prev.y = pos.y;
 }
 
 void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
 {
+    plt::HeldItem held = getHeldItem(e, player);
+
+    // While a menu is open the only input is the option picked in it
     if (player.cooking_zone != plt::CookingZone_None)
+    {
+        if (tick_input.menu_select != plt::MenuSelect_None)
+            applyMenuSelection(e, player, held, tick_input.menu_select);
+
         return;
+    }
 
     //--------------------------------------------------------------------------------------
     // Handle player movement and walk cycle
@@ -531,29 +854,32 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
     Vector2 dist = {0, 0};
     plt::PlayerMvnmtState prev_move_state = player.move_state;
 
-    if (IsKeyDown(KeyboardKey::KEY_S))
+    if (tick_input.down)
     {
         dist.y += 1;
         player.move_state = plt::PlayerMvnmtState_Forward;
     }
-    if (IsKeyDown(KeyboardKey::KEY_A))
+    if (tick_input.left)
     {
         dist.x -= 1;
         player.move_state = plt::PlayerMvnmtState_Left;
     }
-    if (IsKeyDown(KeyboardKey::KEY_D))
+    if (tick_input.right)
     {
         dist.x += 1;
         player.move_state = plt::PlayerMvnmtState_Right;
     }
-    if (IsKeyDown(KeyboardKey::KEY_W))
+    if (tick_input.up)
     {
         dist.y -= 1;
         player.move_state = plt::PlayerMvnmtState_Back;
     }
 
+    // Pixels per second
+    const float player_speed = 240;
+
     dist = Vector2Normalize(dist);
-    dist = Vector2Scale(dist, 4);
+    dist = Vector2Scale(dist, player_speed * ecs_world->delta_time());
     dist = Vector2Add(Vector2{pos.x, pos.y}, dist);
 
     pos.x = dist.x;
@@ -569,10 +895,9 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
 
     plt::CookingZoneType new_zone_type = plt::CookingZone_None;
 
-    if (IsKeyDown(KEY_E))
+    if (tick_input.interact)
     {
-        flecs::filter<plt::CookingZone> cooking_zone_f = ecs_world->filter<plt::CookingZone>();
-        cooking_zone_f.each([&](flecs::entity e, plt::CookingZone &c_zone)
+        cooking_zone_q.each([&](flecs::entity e, plt::CookingZone &c_zone)
                             {
                                 if (!pointInAABB(rectToAABB(c_zone.zone), c2v{pos.x, pos.y}))
                                     return;
@@ -604,11 +929,9 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
 
     // Only go into the sink if you are holding an EMPTY bowl
     case plt::CookingZone_Sink:
-        if (player.holding_type == plt::PlayerHoldingType_Dish)
+        if (held.dish)
         {
-            flecs::entity dish = ecs_world->get_alive(player.item);
-            plt::Dish *dish_info = dish.get_mut<plt::Dish>();
-            if (dish_info->type == plt::DishType_Bowl && dish_info->fill == plt::BowlFillType_None)
+            if (held.entity.get<plt::DishInfo>()->type == plt::DishType_Bowl && held.dish->fill == plt::BowlFillType_None)
             {
                 player.cooking_zone = plt::CookingZone_Sink;
             }
@@ -618,12 +941,9 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
     // Only go into the cutting board menu if:
     // Holding a Whole, non-cookable ingredient
     case plt::CookingZone_CuttingBoard:
-        if (player.holding_type == plt::PlayerHoldingType_Ingredient)
+        if (held.ing)
         {
-            flecs::entity ing_e = ecs_world->get_alive(player.item);
-            plt::Ingredient *ing_info = ing_e.get_mut<plt::Ingredient>();
-
-            if (!ing_info->cookable && ing_info->state == plt::Whole)
+            if (!held.entity.get<plt::IngredientInfo>()->cookable && held.ing->state == plt::Whole)
             {
                 player.cooking_zone = plt::CookingZone_CuttingBoard;
             }
@@ -633,12 +953,9 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
     // Only go into the stove menu if:
     // Holding a Whole, cookable ingredient
     case plt::CookingZone_Stove:
-        if (player.holding_type == plt::PlayerHoldingType_Ingredient)
+        if (held.ing)
         {
-            flecs::entity ing_e = ecs_world->get_alive(player.item);
-            plt::Ingredient *ing_info = ing_e.get_mut<plt::Ingredient>();
-
-            if (ing_info->cookable && ing_info->state == plt::Whole)
+            if (held.entity.get<plt::IngredientInfo>()->cookable && held.ing->state == plt::Whole)
             {
                 player.cooking_zone = plt::CookingZone_Stove;
             }
@@ -647,25 +964,21 @@ void App::PlayerSystem(flecs::entity e, plt::Position &pos, plt::Player &player)
 
     // Plate a a dish/ingredient only if it the correct one
     case plt::CookingZone_Plating:
-        if (isPlayerHoldingRightPiece(player, customers.back().order))
+        if (isPlayerHoldingRightPiece(held, customers.back().order))
         {
             // Put item into the order
             customers.back().order.completion += 1;
 
-            // Delete the item in your hand
-            ecs_world->get_alive(player.item).destruct();
-            player.holding_type = plt::PlayerHoldingType_None;
+            // Return the item in your hand to the pool
+            releaseHeldItem(e, player, held);
         }
         break;
 
     // Only go into the trash if you ARE holding something
     case plt::CookingZone_Trash:
         // If we're holding an item, throw it out
-        if (player.holding_type != plt::PlayerHoldingType_None)
-        {
-            ecs_world->get_alive(player.item).destruct();
-            player.holding_type = plt::PlayerHoldingType_None;
-        }
+        if (held.entity)
+            releaseHeldItem(e, player, held);
         break;
 
     default:
@@ -682,31 +995,32 @@ void App::CollisionSystem(flecs::entity e, plt::Position &pos, plt::Collider &co
     coll.body.max.y = pos.y + coll.bounds.y + coll.bounds.height;
 }
 
-void App::DynamicBodySystem(flecs::entity e, plt::Position &pos, plt::Collider &coll)
+void App::DynamicBodySystem(flecs::entity e, plt::Position &pos, plt::Collider &coll, int stage)
 {
-    flecs::filter<plt::Position, plt::Collider, plt::SolidBody> solid_body_f = ecs_world->filter<plt::Position, plt::Collider, plt::SolidBody>();
-    solid_body_f.each([&](flecs::entity s_e, plt::Position &s_pos, plt::Collider &s_coll, plt::SolidBody &sol)
-                      {
-                          // Collision detection and mainfold generation
-                          c2Manifold m;
-                          c2AABBtoAABBManifold(coll.body, s_coll.body, &m);
+    std::vector<int> &nearby = nearby_solids[stage];
 
-                          // Leave if there's no collision
-                          if (m.count == 0)
-                              return;
+    // Only test the solid bodies sharing a grid cell with this body
+    solid_grid->query(coll.body, nearby);
 
-                          // Resolve the collision if there is one
-                          Vector2 n = {m.n.x, m.n.y};
-                          for (int i = 0; i < m.count; i++)
-                          {
-                              Vector2 p = {m.contact_points[i].x, m.contact_points[i].y};
-                              float d = m.depths[i];
-                              pos.x -= n.x * d;
-                              pos.y -= n.y * d;
-                          }
+    for (int solid : nearby)
+    {
+        // Collision detection and mainfold generation
+        c2Manifold m;
+        c2AABBtoAABBManifold(coll.body, solid_grid->getAABB(solid), &m);
 
-                          //
-                      });
+        // Skip if there's no collision
+        if (m.count == 0)
+            continue;
+
+        // Resolve the collision if there is one
+        Vector2 n = {m.n.x, m.n.y};
+        for (int i = 0; i < m.count; i++)
+        {
+            float d = m.depths[i];
+            pos.x -= n.x * d;
+            pos.y -= n.y * d;
+        }
+    }
 }
 
 void App::CustomerSystem()
@@ -755,7 +1069,7 @@ void App::CustomerSystem()
     Rectangle leave_point = {-1 * 32, 7 * 32, 32, 32};
 
     // Change state
-    if (customers.back().order.completion == customers.back().order.indicies.size() && customers.back().state == plt::CustomerState_InLine)
+    if (customers.back().order.completion == customers.back().order.part_count && customers.back().state == plt::CustomerState_InLine)
     {
         customers.back().state = plt::CustomerState_GettingFood;
     }
@@ -777,10 +1091,17 @@ void App::CustomerSystem()
 
     int cust_size = customers.size();
 
-    const float customer_speed = 1.3;
+    // Pixels per second
+    const float customer_speed = 78;
+    const float line_speed = 30;
+
+    float dt = ecs_world->delta_time();
 
     for (int i = 0; i < cust_size; i++)
     {
+        // Remember where this tick started for render interpolation
+        customers[cust_size - 1 - i].prev_pos = customers[cust_size - 1 - i].pos;
+
         switch (customers[cust_size - 1 - i].state)
         {
         case plt::CustomerState_InLine: // Wait in line
@@ -789,12 +1110,14 @@ void App::CustomerSystem()
             Vector2 dest_pos = {6 * 32, 8.f * 32 + i * 15};
 
             Vector2 v = Vector2Subtract(dest_pos, cust_pos);
+            float dist = Vector2Length(v);
 
-            if (std::abs(Vector2Length(v)) < 0.5)
+            if (dist < 0.5)
                 break;
 
+            // Don't step past the spot in line
             v = Vector2Normalize(v);
-            v = Vector2Scale(v, 0.5);
+            v = Vector2Scale(v, std::min(line_speed * dt, dist));
 
             customers[cust_size - 1 - i].pos = Vector2Add(cust_pos, v);
         }
@@ -807,7 +1130,7 @@ void App::CustomerSystem()
 
             Vector2 v = Vector2Subtract(dest_pos, cust_pos);
             v = Vector2Normalize(v);
-            v = Vector2Scale(v, customer_speed);
+            v = Vector2Scale(v, customer_speed * dt);
 
             customers[cust_size - 1 - i].pos = Vector2Add(cust_pos, v);
         }
@@ -820,7 +1143,7 @@ void App::CustomerSystem()
 
             Vector2 v = Vector2Subtract(dest_pos, cust_pos);
             v = Vector2Normalize(v);
-            v = Vector2Scale(v, customer_speed);
+            v = Vector2Scale(v, customer_speed * dt);
 
             customers[cust_size - 1 - i].pos = Vector2Add(cust_pos, v);
         }
@@ -832,12 +1155,58 @@ void App::CustomerSystem()
     }
 }
 
+void App::GameStateSystem()
+{
+    switch (game_state)
+    {
+    // PLAY was picked
+    case plt::GameState_MainMenu:
+        if (tick_input.menu_select != plt::MenuSelect_None)
+            game_state = plt::GameState_Day1Intro;
+        return;
+
+    // Devil dialogue, SPACE moves through it and the day starts when it runs out
+    case plt::GameState_Day1Intro:
+        if (tick_input.advance && Day1Dialogue.size() != 0)
+            Day1Dialogue.pop_back();
+        if (Day1Dialogue.size() == 0)
+            game_state = plt::GameState_Day1;
+        break;
+
+    case plt::GameState_Day2Intro:
+        if (tick_input.advance && Day2Dialogue.size() != 0)
+            Day2Dialogue.pop_back();
+        if (Day2Dialogue.size() == 0)
+            game_state = plt::GameState_Day2;
+        break;
+
+    case plt::GameState_Day3Intro:
+        if (tick_input.advance && Day3Dialogue.size() != 0)
+            Day3Dialogue.pop_back();
+        if (Day3Dialogue.size() == 0)
+            game_state = plt::GameState_Day3;
+        break;
+
+    // The clock stops once we've ascended
+    case plt::GameState_Outro:
+        return;
+
+    default:
+        break;
+    }
+
+    // Speedrun time counter
+    time_counter += ecs_world->delta_time();
+}
+
 //--------------------------------------------------------------------------------------
 // Handling Game Music
 //--------------------------------------------------------------------------------------
 
 void App::handleGameMusic()
 {
+    TRACE_ZONE("App::handleGameMusic");
+
     if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && !is_audio_initialized)
     {
         is_audio_initialized = true;
@@ -931,6 +1300,46 @@ void App::RenderSystem()
     handleGameMusic();
 
     BeginDrawing();
+
+    frame_arena->reset();
+
+    // Worst case sprite count: every chef plus every front tile. Grows here, never inside the counted region
+    sprite_batch->reserve(player_sprite_q.count() + map->getFrontTileCount());
+
+    uint64_t allocs_before = getAllocCount();
+
+    // Timed up to, not including, the buffer swap (which waits on vsync/the frame limiter)
+    {
+        Profiler::Scope scope(profiler.get(), ProfileSlot_Render);
+        renderScene();
+    }
+
+    // Once a day has been running for a few frames (buffers grown, music loaded) drawing it shouldn't
+    // touch the heap, allocator churn shows up as frame spikes in the web build. tests/AllocTest.cpp
+    // enforces it, a running game only warns once
+    if (render_game_state != game_state)
+    {
+        render_game_state = game_state;
+        render_state_frames = 0;
+    }
+    render_state_frames++;
+
+    render_frame_allocs = getAllocCount() - allocs_before;
+
+    bool day_running = game_state == plt::GameState_Day1 || game_state == plt::GameState_Day2 || game_state == plt::GameState_Day3;
+    if (day_running && render_state_frames > 2 && render_frame_allocs > 0 && !render_alloc_warned)
+    {
+        TraceLog(LOG_WARNING, "RENDER: drawing a day frame made %llu heap allocations", (unsigned long long)render_frame_allocs);
+        render_alloc_warned = true;
+    }
+
+    renderDebugOverlay();
+
+    EndDrawing();
+}
+
+void App::renderScene()
+{
     ClearBackground(RAYWHITE);
 
     // Main menu
@@ -940,138 +1349,148 @@ void App::RenderSystem()
 
         setGuiTextStyle(lookout_font, ColorToInt(Color{0x2B, 0x26, 0x27, 0xFF}), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 3, 30);
         if (GuiButton(Rectangle{screen_w * 0.25f, 250, screen_w - (screen_w * 0.5f), 50}, "PLAY"))
-            game_state = plt::GameState_Day1Intro;
+            pending_menu_select = 0;
 
-        // DrawTextureRec(logo_tex, {0, 0, (float)logo_tex.width, (float)logo_tex.height}, {screen_w / 2 - (float)logo_tex.width / 2 + 1, 50 + 1}, BLACK);
-        DrawTextureRec(logo_tex, {0, 0, (float)logo_tex.width, (float)logo_tex.height}, {screen_w / 2 - (float)logo_tex.width / 2, 50}, WHITE);
+        Vector2 logo_size = sprite_atlas->getSourceSize(logo_sheet);
+        drawSprite(logo_sheet, {0, 0, logo_size.x, logo_size.y}, {screen_w / 2 - logo_size.x / 2, 50, logo_size.x, logo_size.y}, WHITE);
 
-        EndDrawing();
         return;
     }
     else if (game_state == plt::GameState_Outro)
     {
-        DrawTexture(outro_tex, 0, 0, WHITE);
+        Vector2 outro_size = sprite_atlas->getSourceSize(outro_sheet);
+        drawSprite(outro_sheet, {0, 0, outro_size.x, outro_size.y}, {0, 0, outro_size.x, outro_size.y}, WHITE);
 
         setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 80, 50);
         GuiLabel(Rectangle{0 + 2, 10 + 2, (float)screen_w, 250}, "You Have Ascended\nTo Heaven");
         setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 80, 50);
         GuiLabel(Rectangle{0, 10, (float)screen_w, 250}, "You Have Ascended\nTo Heaven");
 
-        std::stringstream speedrun_stream;
-        speedrun_stream << std::fixed << std::setprecision(2) << time_counter;
+        const char *speedrun_str = frame_arena->format("Time: %.2f", time_counter);
 
         setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 35, 30);
-        GuiLabel({0 + 2, screen_h - 100.f + 2, (float)screen_w, 40}, ("Time: " + speedrun_stream.str()).c_str());
+        GuiLabel({0 + 2, screen_h - 100.f + 2, (float)screen_w, 40}, speedrun_str);
         setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 35, 30);
-        GuiLabel({0, screen_h - 100.f, (float)screen_w, 40}, ("Time: " + speedrun_stream.str()).c_str());
+        GuiLabel({0, screen_h - 100.f, (float)screen_w, 40}, speedrun_str);
 
-        EndDrawing();
         return;
     }
 
-    // Speedrun time counter
-    time_counter += ecs_world->delta_time();
-
     //--------------------------------------------------------------------------------------
     // Render Map
     //--------------------------------------------------------------------------------------
-    map->draw();
+    map->draw(Rectangle{0, 0, (float)screen_w, (float)screen_h});
 
     //--------------------------------------------------------------------------------------
-    // Clear previous frame render orders
+    // Clear previous frame sprites
     //--------------------------------------------------------------------------------------
-    render_orders.clear();
+    sprite_batch->clear();
 
     //--------------------------------------------------------------------------------------
     // Render Animated Player
     //--------------------------------------------------------------------------------------
-    flecs::filter<plt::Position, plt::Player> player_f = ecs_world->filter<plt::Position, plt::Player>();
-    player_f.each([&](flecs::entity e, plt::Position &pos, plt::Player &player)
-                  {
-                      if (player.on_farmable_land)
-                      {
-                          Rectangle highlight_rect = {std::floor(pos.x / 16.f) * 16.f,
-                                                      std::floor(pos.y / 16.f) * 16.f,
-                                                      16,
-                                                      16};
-                          DrawRectangleRec(highlight_rect, ColorAlpha(WHITE, 0.3));
-                      }
-
-                      // Subtract a bit more than 32 from y so sprite is a bit above the colliders
-                      Vector2 draw_pos = {round(pos.x - 16), round(pos.y - 40)};
-
-                      const Color ghost_color = ColorAlpha(WHITE, 0.8);
-
-                      switch (player.move_state)
-                      {
-                      case plt::PlayerMvnmtState_Left:
-                          render_orders.push_back({pos.y, player_tex, Rectangle{32.f * (player.current_frame + 12), 0, 32, 32}, draw_pos, ghost_color});
-                          break;
-                      case plt::PlayerMvnmtState_Right:
-                          render_orders.push_back({pos.y, player_tex, Rectangle{32.f * (player.current_frame + 4), 0, 32, 32}, draw_pos, ghost_color});
-                          break;
-                      case plt::PlayerMvnmtState_Back:
-                          render_orders.push_back({pos.y, player_tex, Rectangle{32.f * (player.current_frame + 8), 0, 32, 32}, draw_pos, ghost_color});
-                          break;
-                      case plt::PlayerMvnmtState_Forward:
-                          render_orders.push_back({pos.y, player_tex, Rectangle{32.f * player.current_frame, 0, 32, 32}, draw_pos, ghost_color});
-                          break;
-                      default:
-                          break;
-                      }
-                      //
-                  });
+    player_sprite_q.each([&](flecs::entity e, plt::Position &sim_pos, plt::PrevPosition &prev, plt::Player &player)
+                         {
+                             // Interpolated between the last two simulation ticks
+                             Vector2 pos = {Lerp(prev.x, sim_pos.x, sim_alpha), Lerp(prev.y, sim_pos.y, sim_alpha)};
+
+                             if (player.on_farmable_land)
+                             {
+                                 Rectangle highlight_rect = {std::floor(pos.x / 16.f) * 16.f,
+                                                             std::floor(pos.y / 16.f) * 16.f,
+                                                             16,
+                                                             16};
+                                 DrawRectangleRec(highlight_rect, ColorAlpha(WHITE, 0.3));
+                             }
+
+                             // Subtract a bit more than 32 from y so sprite is a bit above the colliders
+                             Vector2 draw_pos = {round(pos.x - 16), round(pos.y - 40)};
+
+                             const Color ghost_color = ColorAlpha(WHITE, 0.8);
+
+                             // Frame on the strip, four frames per direction
+                             int strip_frame = -1;
+
+                             switch (player.move_state)
+                             {
+                             case plt::PlayerMvnmtState_Left:
+                                 strip_frame = player.current_frame + 12;
+                                 break;
+                             case plt::PlayerMvnmtState_Right:
+                                 strip_frame = player.current_frame + 4;
+                                 break;
+                             case plt::PlayerMvnmtState_Back:
+                                 strip_frame = player.current_frame + 8;
+                                 break;
+                             case plt::PlayerMvnmtState_Forward:
+                                 strip_frame = player.current_frame;
+                                 break;
+                             default:
+                                 break;
+                             }
+
+                             if (strip_frame >= 0)
+                             {
+                                 AtlasSprite sprite = sprite_atlas->resolve(player_sheet, Rectangle{32.f * strip_frame, 0, 32, 32});
+                                 sprite_batch->add(sprite.tex, sprite.src, draw_pos, ghost_color, pos.y);
+                             }
+                             //
+                         });
 
     //--------------------------------------------------------------------------------------
     // Render all textures with y-level sorting
     //--------------------------------------------------------------------------------------
 
-    flecs::filter<plt::CookingZone> zone_f = ecs_world->filter<plt::CookingZone>();
-    zone_f.each([&](flecs::entity e, plt::CookingZone &zone)
-                {
-                    drawPulseRect(zone.zone); //
-                });
+    cooking_zone_q.each([&](flecs::entity e, plt::CookingZone &zone)
+                        {
+                            drawPulseRect(zone.zone); //
+                        });
+
+    // Front layer tiles sort with the sprites, so furniture covers the chef only while they're behind it
+    map->queueFront(*sprite_batch, Rectangle{0, 0, (float)screen_w, (float)screen_h});
 
-    std::sort(render_orders.begin(), render_orders.end(), compSPR);
-    for (auto &spr : render_orders)
     {
-        DrawTextureRec(spr.tex, spr.source, spr.position, spr.color);
+        TRACE_ZONE("SpriteBatch::draw");
+        sprite_batch->draw();
     }
 
-    map->drawFront();
-
     if (customers.size() != 0)
     {
         // Draw parts of the order on the counter
         if (customers.back().state == plt::CustomerState_InLine || customers.back().state == plt::CustomerState_GettingFood)
         {
             Rectangle order_target_rectangle = {3 * 32, 5 * 32, 32, 32};
-            int i = 0;
-            for (auto &index : customers.back().order.indicies)
+            plt::Order &order = customers.back().order;
+            for (int i = 0; i < order.completion && i < order.part_count; i++)
             {
-                if (i >= customers.back().order.completion)
-                    break;
-
-                switch (index.first)
+                switch (plt::getItemKind(order.parts[i]))
                 {
-                case 0: // Dishes
-                    renderDish(customers.back().order.dishes[index.second], order_target_rectangle, WHITE);
-                    break;
+                case plt::ItemKind_Dish:
+                {
+                    plt::Dish dish = plt::getItemDish(order.parts[i]);
+                    renderDish(dish, order_target_rectangle, WHITE);
+                }
+                break;
 
-                case 1:
-                    renderIngredient(customers.back().order.ingredients[index.second], order_target_rectangle, WHITE);
-                    break;
+                case plt::ItemKind_Ingredient:
+                {
+                    plt::Ingredient ing = plt::getItemIngredient(order.parts[i]);
+                    renderIngredient(ing, order_target_rectangle, WHITE);
+                }
+                break;
 
                 default:
                     break;
                 }
-                i++;
             }
         }
 
         // Draw Customers
         for (int i = customers.size() - 1; i >= 0; i--)
-            DrawTextureRec(customer_tex, {customers[i].facing * 32.f, customers[i].type * 32.f, 32, 32}, customers[i].pos, customers[i].col);
+        {
+            Vector2 customer_pos = Vector2Lerp(customers[i].prev_pos, customers[i].pos, sim_alpha);
+            drawSprite(customer_sheet, {customers[i].facing * 32.f, customers[i].type * 32.f, 32, 32}, {customer_pos.x, customer_pos.y, 32, 32}, customers[i].col);
+        }
     }
     //--------------------------------------------------------------------------------------
     // Render GUI
@@ -1082,37 +1501,37 @@ void App::RenderSystem()
         game_state == plt::GameState_Day2 ||
         game_state == plt::GameState_Day3)
     {
-        flecs::filter<plt::Position, plt::Player> inv_f = ecs_world->filter<plt::Position, plt::Player>();
-        inv_f.each([&](flecs::entity e, plt::Position &pos, plt::Player &player)
-                   {
-                       switch (player.cooking_zone)
-                       {
-                       case plt::CookingZone_None:
-                           renderPlayerInventory(e, pos, player);
-                           if (customers.size() > 0)
-                               renderOrderInstr(customers.back().order);
-                           break;
-                       case plt::CookingZone_Bag:
-                           renderBagMenu(e, pos, player);
-                           break;
-                       case plt::CookingZone_Dishes:
-                           renderDishMenu(e, pos, player);
-                           break;
-                       case plt::CookingZone_Sink:
-                           renderSinkMenu(e, pos, player);
-                           break;
-                       case plt::CookingZone_CuttingBoard:
-                           renderCuttingBoardMenu(e, pos, player);
-                           break;
-                       case plt::CookingZone_Stove:
-                           renderStoveMenu(e, pos, player);
-                           break;
-
-                       default:
-                           break;
-                       }
-                       //
-                   });
+        player_q.each([&](flecs::entity e, plt::Position &pos, plt::Player &player)
+                      {
+                          plt::HeldItem held = getHeldItem(e, player);
+
+                          switch (player.cooking_zone)
+                          {
+                          case plt::CookingZone_None:
+                              renderPlayerInventory(e, pos, player, held);
+                              if (customers.size() > 0)
+                                  renderOrderInstr(customers.back().order);
+                              break;
+                          case plt::CookingZone_Bag:
+                              renderBagMenu(e, pos, player);
+                              break;
+                          case plt::CookingZone_Dishes:
+                              renderDishMenu(e, pos, player);
+                              break;
+                          case plt::CookingZone_Sink:
+                              renderSinkMenu(e, pos, player);
+                              break;
+                          case plt::CookingZone_CuttingBoard:
+                              renderCuttingBoardMenu(e, pos, player, held);
+                              break;
+                          case plt::CookingZone_Stove:
+                              renderStoveMenu(e, pos, player, held);
+                              break;
+                          default:
+                              break;
+                          }
+                          //
+                      });
     }
 
     //--------------------------------------------------------------------------------------
@@ -1123,11 +1542,9 @@ void App::RenderSystem()
     {
     case plt::GameState_Day1Intro:
     {
+        // The simulation moves on to the day once the dialogue runs out
         if (Day1Dialogue.size() == 0)
-        {
-            game_state = plt::GameState_Day1;
             break;
-        }
 
         Rectangle speech_box_rect = Rectangle{10, screen_h - 110.f, screen_w - 20.f, 100};
         Rectangle speech_rect = Rectangle{speech_box_rect.x + 100, speech_box_rect.y, speech_box_rect.width - 100, 100};
@@ -1138,19 +1555,14 @@ void App::RenderSystem()
 
         setGuiTextStyle(lookout_font, ColorToInt(WHITE), TEXT_ALIGN_LEFT, TEXT_ALIGN_TOP, 40, 30);
         GuiLabel(speech_rect, Day1Dialogue.back().c_str());
-
-        if (IsKeyPressed(KEY_SPACE))
-            Day1Dialogue.pop_back();
     }
     break;
 
     case plt::GameState_Day2Intro:
     {
+        // The simulation moves on to the day once the dialogue runs out
         if (Day2Dialogue.size() == 0)
-        {
-            game_state = plt::GameState_Day2;
             break;
-        }
 
         Rectangle speech_box_rect = Rectangle{10, screen_h - 110.f, screen_w - 20.f, 100};
         Rectangle speech_rect = Rectangle{speech_box_rect.x + 100, speech_box_rect.y, speech_box_rect.width - 100, 100};
@@ -1161,19 +1573,14 @@ void App::RenderSystem()
 
         setGuiTextStyle(lookout_font, ColorToInt(WHITE), TEXT_ALIGN_LEFT, TEXT_ALIGN_TOP, 40, 30);
         GuiLabel(speech_rect, Day2Dialogue.back().c_str());
-
-        if (IsKeyPressed(KEY_SPACE))
-            Day2Dialogue.pop_back();
     }
     break;
 
     case plt::GameState_Day3Intro:
     {
+        // The simulation moves on to the day once the dialogue runs out
         if (Day3Dialogue.size() == 0)
-        {
-            game_state = plt::GameState_Day3;
             break;
-        }
 
         Rectangle speech_box_rect = Rectangle{10, screen_h - 110.f, screen_w - 20.f, 100};
         Rectangle speech_rect = Rectangle{speech_box_rect.x + 100, speech_box_rect.y, speech_box_rect.width - 100, 100};
@@ -1187,9 +1594,6 @@ void App::RenderSystem()
 
         if (Day3Dialogue.size() == 1)
             renderDevil({496.f, 64.f, 64.f, 64.f}, WHITE);
-
-        if (IsKeyPressed(KEY_SPACE))
-            Day3Dialogue.pop_back();
     }
     break;
 
@@ -1201,20 +1605,17 @@ void App::RenderSystem()
     // Render Speedrunning timer
     //--------------------------------------------------------------------------------------
 
-    std::stringstream speedrun_stream;
-    speedrun_stream << std::fixed << std::setprecision(2) << time_counter;
+    const char *speedrun_str = frame_arena->format("%.2f", time_counter);
 
     setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_LEFT, TEXT_ALIGN_BOTTOM, 28, 30);
-    GuiLabel({10 + 1, screen_h - 40.f + 1, 200, 40}, speedrun_stream.str().c_str());
+    GuiLabel({10 + 1, screen_h - 40.f + 1, 200, 40}, speedrun_str);
     setGuiTextStyle(lookout_font, ColorToInt(WHITE), TEXT_ALIGN_LEFT, TEXT_ALIGN_BOTTOM, 28, 30);
-    GuiLabel({10, screen_h - 40.f, 200, 40}, speedrun_stream.str().c_str());
+    GuiLabel({10, screen_h - 40.f, 200, 40}, speedrun_str);
 
     //--------------------------------------------------------------------------------------
-    // DEBUG RENDER SETTINGS
+    // DEBUG RENDER SETTINGS (toggles live in the F3 overlay)
     //--------------------------------------------------------------------------------------
 
-    // GuiToggle(Rectangle{screen_w - 10.f - 100, 10, 100, 20}, "Render Colliders", &render_colliders);
-    // GuiToggle(Rectangle{screen_w - 10.f - 100, 40, 100, 20}, "Render Positions", &render_positions);
     // GuiSpinner(Rectangle{screen_w - 10.f - 100, 70, 100, 20}, "", (int *)&game_state, 0, (int)plt::GameState_Outro, false);
 
     //--------------------------------------------------------------------------------------
@@ -1222,8 +1623,7 @@ void App::RenderSystem()
     //--------------------------------------------------------------------------------------
     if (render_colliders)
     {
-        flecs::filter<plt::Position, plt::Collider> collider_f = ecs_world->filter<plt::Position, plt::Collider>();
-        collider_f.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll)
+        collider_q.each([&](flecs::entity e, plt::Position &pos, plt::Collider &coll)
                         {
                             Rectangle collider_rect = {coll.body.min.x, coll.body.min.y, coll.body.max.x - coll.body.min.x, coll.body.max.y - coll.body.min.y};
                             DrawRectangleLinesEx(collider_rect, 1, BLACK);
@@ -1236,16 +1636,33 @@ void App::RenderSystem()
     //--------------------------------------------------------------------------------------
     if (render_positions)
     {
-        flecs::filter<plt::Position> pos_f = ecs_world->filter<plt::Position>();
-        pos_f.each([&](flecs::entity e, plt::Position &pos)
-                   {
-                       DrawCircleV(Vector2{pos.x, pos.y}, 4, ORANGE);
-                       DrawCircleV(Vector2{pos.x, pos.y}, 3, RED);
-                       //
-                   });
+        position_q.each([&](flecs::entity e, plt::Position &pos)
+                        {
+                            DrawCircleV(Vector2{pos.x, pos.y}, 4, ORANGE);
+                            DrawCircleV(Vector2{pos.x, pos.y}, 3, RED);
+                            //
+                        });
     }
+}
 
-    EndDrawing();
+//--------------------------------------------------------------------------------------
+// Debug Overlay (F3)
+//--------------------------------------------------------------------------------------
+void App::renderDebugOverlay()
+{
+    if (!profiler->isVisible())
+        return;
+
+    profiler->draw(10, 10);
+
+    DrawRectangle(10, 240, 300, 48, Fade(BLACK, 0.75f));
+    DrawText(frame_arena->format("items: %d live, %d pooled, %.0f%% reused (%u picks)", item_pool->getLiveCount(), item_pool->getFreeCount(), item_pool->getHitRate() * 100.f, item_pool->getAcquireCount()),
+             16, 245, 10, LIGHTGRAY);
+    DrawText(frame_arena->format("map chunks: %d baked of %d, %d front tiles", map->getBakedChunkCount(), map->getChunkCount(), map->getFrontTileCount()), 16, 259, 10, LIGHTGRAY);
+    DrawText(frame_arena->format("sprite atlas: %d pages, %d separate textures", sprite_atlas->getPageCount(), sprite_atlas->getFallbackCount()), 16, 273, 10, LIGHTGRAY);
+
+    GuiToggle(Rectangle{screen_w - 10.f - 100, 10, 100, 20}, "Render Colliders", &render_colliders);
+    GuiToggle(Rectangle{screen_w - 10.f - 100, 40, 100, 20}, "Render Positions", &render_positions);
 }
 
 void App::drawAttentionArrow(Vector2 target)
@@ -1261,12 +1678,12 @@ void App::drawAttentionArrow(Vector2 target)
                  Vector2{target.x - 10, target.y - 70 + text_y_add.val}, YELLOW);
 }
 
-void App::drawTutorialText(std::string text)
+void App::drawTutorialText(const char *text)
 {
     GuiSetStyle(DEFAULT, TEXT_COLOR_NORMAL, ColorToInt(ColorAlpha(BLACK, 0.9)));
-    GuiLabel(Rectangle{screen_w / 2.f - 200 + 2, screen_h / 2.f - 240 + text_y_add.val + 2, 400, 200}, text.c_str());
+    GuiLabel(Rectangle{screen_w / 2.f - 200 + 2, screen_h / 2.f - 240 + text_y_add.val + 2, 400, 200}, text);
     GuiSetStyle(DEFAULT, TEXT_COLOR_NORMAL, ColorToInt(MAROON));
-    GuiLabel(Rectangle{screen_w / 2.f - 200, screen_h / 2.f - 240 + text_y_add.val, 400, 200}, text.c_str());
+    GuiLabel(Rectangle{screen_w / 2.f - 200, screen_h / 2.f - 240 + text_y_add.val, 400, 200}, text);
 }
 
 void App::drawPulseRect(Rectangle pulse_rec)
@@ -1274,43 +1691,32 @@ void App::drawPulseRect(Rectangle pulse_rec)
     DrawRectangleLinesEx(pulse_rec, 1, ColorAlpha(RED, inv_scale.val));
 }
 
-void App::renderPlayerInventory(flecs::entity e, plt::Position &pos, plt::Player &player)
+void App::renderPlayerInventory(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held)
 {
+    TRACE_ZONE("App::renderPlayerInventory");
+
     // Draw Background Rectangle
     Rectangle inv_rect = Rectangle{screen_w - 110.f, screen_h - 110.f, 100, 100};
     DrawRectangleRec(inv_rect, ColorAlpha(WHITE, 0.4));
 
-    if (player.holding_type == plt::PlayerHoldingType_None)
+    if (!held.entity)
         return;
 
-    // Get the item the player is holding
-    flecs::entity item = ecs_world->get_alive(player.item);
-
     // Target Rectangle (within a margin of the inv_rect)
     Rectangle target_rec = {inv_rect.x + 10.f, inv_rect.y + 10.f, inv_rect.width - 20.f, inv_rect.height - 20.f};
     Vector2 origin = {target_rec.width / 2, target_rec.height / 2};
 
-    // Switch based on what type of item we're holding
-    switch (player.holding_type)
-    {
-
-    // Render an ingredient item
-    case plt::PlayerHoldingType_Ingredient:
-        renderIngredient(*(item.get_mut<plt::Ingredient>()), target_rec, WHITE);
-        break;
-
-    // Render a dish item
-    case plt::PlayerHoldingType_Dish:
-        renderDish(*(item.get_mut<plt::Dish>()), target_rec, WHITE);
-        break;
-
-    default:
-        break;
-    }
+    // Render an ingredient or dish item, whichever we're holding
+    if (held.ing)
+        renderIngredient(*held.ing, target_rec, WHITE);
+    else if (held.dish)
+        renderDish(*held.dish, target_rec, WHITE);
 }
 
 void App::renderBagMenu(flecs::entity e, plt::Position &pos, plt::Player &player)
 {
+    TRACE_ZONE("App::renderBagMenu");
+
     // Menu background
     Rectangle menu_rec = Rectangle{10.f, 10.f, screen_w - 20.f, screen_h - 20.f};
     DrawRectangleRec(menu_rec, ColorAlpha(WHITE, 0.7));
@@ -1324,26 +1730,20 @@ void App::renderBagMenu(flecs::entity e, plt::Position &pos, plt::Player &player
     // Exit Button
     setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 4, 30);
     if (GuiButton(Rectangle{menu_rec.x + 10, menu_rec.y + 10, 100.f, 35}, "Exit"))
-        player.cooking_zone = plt::CookingZone_None;
+        pending_menu_select = plt::MenuSelect_Exit;
 
     // Draw ingredient buttons
-    int i = 0;
-    for (auto ing : ingredients)
+    for (int i = 0; i < ingredient_prefabs.size(); i++)
     {
+        const plt::IngredientInfo &ing = getIngredientInfo(i);
+
         // Rectangle where this ingredient will be drawn
         Rectangle ing_rec = {menu_rec.x + 10 + 66 * (i % 9), menu_rec.y + 80 + 66 * (i / 9), 64, 64};
 
         if (GuiButton(ing_rec, ""))
-        {
-            flecs::entity ing_e = ecs_world->entity();
-            ing_e.set<plt::Ingredient>(ing);
+            pending_menu_select = i;
 
-            player.holding_type = plt::PlayerHoldingType_Ingredient;
-            player.item = ing_e.id();
-            player.cooking_zone = plt::CookingZone_None;
-        }
-
-        DrawTexturePro(meals_tex, {ing.pos.x, ing.pos.y, 32, 32}, ing_rec, {0.f, 0.f}, 0, WHITE);
+        drawSprite(meals_sheet, {ing.pos.x, ing.pos.y, 32, 32}, ing_rec, WHITE);
 
         Vector2 mouse_pos = GetMousePosition();
         if (pointInAABB(rectToAABB(ing_rec), c2v{mouse_pos.x, mouse_pos.y}))
@@ -1354,13 +1754,13 @@ void App::renderBagMenu(flecs::entity e, plt::Position &pos, plt::Player &player
             setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 23, 17);
             GuiLabel({menu_rec.x + 10, menu_rec.y + 45, menu_rec.width - 20.f, 30}, ing.name.c_str());
         }
-
-        i++;
     }
 }
 
 void App::renderDishMenu(flecs::entity e, plt::Position &pos, plt::Player &player)
 {
+    TRACE_ZONE("App::renderDishMenu");
+
     // Menu background
     Rectangle menu_rec = Rectangle{10.f, 10.f, screen_w - 20.f, screen_h - 20.f};
     DrawRectangleRec(menu_rec, ColorAlpha(WHITE, 0.7));
@@ -1374,37 +1774,32 @@ void App::renderDishMenu(flecs::entity e, plt::Position &pos, plt::Player &playe
     // Exit Button
     setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 4, 30);
     if (GuiButton(Rectangle{menu_rec.x + 10, menu_rec.y + 10, 100.f, 35}, "Exit"))
-        player.cooking_zone = plt::CookingZone_None;
+        pending_menu_select = plt::MenuSelect_Exit;
 
     // Draw ingredient buttons
-    int i = 0;
-    for (auto dish : dishes)
+    for (int i = 0; i < dish_prefabs.size(); i++)
     {
+        const plt::DishInfo &dish = getDishInfo(i);
+
         // Rectangle where this ingredient will be drawn
         Rectangle dish_rec = {menu_rec.x + 25 + 276 * i, menu_rec.y + 70, 256, 256};
 
         if (GuiButton(dish_rec, ""))
-        {
-            flecs::entity dish_e = ecs_world->entity();
-            dish_e.set<plt::Dish>(dish);
-
-            player.holding_type = plt::PlayerHoldingType_Dish;
-            player.item = dish_e.id();
-            player.cooking_zone = plt::CookingZone_None;
-        }
+            pending_menu_select = i;
 
         setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 23, 17);
         GuiLabel({dish_rec.x + 1, dish_rec.y + dish_rec.height + 1, dish_rec.width, 40}, dish.name.c_str());
         setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, 23, 17);
         GuiLabel({dish_rec.x, dish_rec.y + dish_rec.height, dish_rec.width, 40}, dish.name.c_str());
 
-        DrawTexturePro(meals_tex, {dish.pos.x, dish.pos.y, 32, 32}, dish_rec, {0.f, 0.f}, 0, WHITE);
-        i++;
+        drawSprite(meals_sheet, {dish.pos.x, dish.pos.y, 32, 32}, dish_rec, WHITE);
     }
 }
 
 void App::renderSinkMenu(flecs::entity e, plt::Position &pos, plt::Player &player)
 {
+    TRACE_ZONE("App::renderSinkMenu");
+
     // Menu background
     Rectangle menu_rec = Rectangle{10.f, 10.f, screen_w - 20.f, screen_h - 20.f};
     DrawRectangleRec(menu_rec, ColorAlpha(WHITE, 0.7));
@@ -1418,7 +1813,7 @@ void App::renderSinkMenu(flecs::entity e, plt::Position &pos, plt::Player &playe
     // Exit Button
     setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 4, 30);
     if (GuiButton(Rectangle{menu_rec.x + 10, menu_rec.y + 10, 100.f, 35}, "Exit"))
-        player.cooking_zone = plt::CookingZone_None;
+        pending_menu_select = plt::MenuSelect_Exit;
 
     // Draw ingredient buttons
     for (int i = 0; i < bowl_fills.size(); i++)
@@ -1427,20 +1822,16 @@ void App::renderSinkMenu(flecs::entity e, plt::Position &pos, plt::Player &playe
         Rectangle fill_rec = {menu_rec.x + 10 + 66 * (i % 9), menu_rec.y + 70 + 66 * (i / 9), 64, 64};
 
         if (GuiButton(fill_rec, ""))
-        {
-            flecs::entity dish = ecs_world->get_alive(player.item);
-            plt::Dish *dish_info = dish.get_mut<plt::Dish>();
-            dish_info->fill = (plt::BowlFillType)(i + 1);
+            pending_menu_select = i;
 
-            player.cooking_zone = plt::CookingZone_None;
-        }
-
-        DrawTexturePro(meals_tex, {bowl_fills[i].x, bowl_fills[i].y, 32, 32}, fill_rec, {0.f, 0.f}, 0, WHITE);
+        drawSprite(meals_sheet, {bowl_fills[i].x, bowl_fills[i].y, 32, 32}, fill_rec, WHITE);
     }
 }
 
-void App::renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Player &player)
+void App::renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held)
 {
+    TRACE_ZONE("App::renderCuttingBoardMenu");
+
     // Menu background
     Rectangle menu_rec = Rectangle{10.f, 10.f, screen_w - 20.f, screen_h - 20.f};
     DrawRectangleRec(menu_rec, ColorAlpha(WHITE, 0.7));
@@ -1454,12 +1845,12 @@ void App::renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Playe
     // Exit Button
     setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 4, 30);
     if (GuiButton(Rectangle{menu_rec.x + 10, menu_rec.y + 10, 100.f, 35}, "Exit"))
-        player.cooking_zone = plt::CookingZone_None;
+        pending_menu_select = plt::MenuSelect_Exit;
 
-    flecs::entity ing_e = ecs_world->get_alive(player.item);
-    plt::Ingredient *ing_info = ing_e.get_mut<plt::Ingredient>();
+    if (!held.ing)
+        return;
 
-    std::vector<std::string> cut_names = {"Left Cut", "Right Cut", "Middle Cut"};
+    static const char *cut_names[] = {"Left Cut", "Right Cut", "Middle Cut"};
 
     // Draw Cutting Options
     for (int i = plt::LeftPile; i < plt::SingleKebab; i++)
@@ -1468,20 +1859,20 @@ void App::renderCuttingBoardMenu(flecs::entity e, plt::Position &pos, plt::Playe
         Rectangle fill_rec = {menu_rec.x + 10, menu_rec.y + 90 + 70 * (i - 1), 64, 64};
 
         setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_LEFT, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 3, 30);
-        GuiLabel({fill_rec.x + 80, fill_rec.y, 200, 64}, cut_names[i - 1].c_str());
+        GuiLabel({fill_rec.x + 80, fill_rec.y, 200, 64}, cut_names[i - 1]);
 
         if (GuiButton(fill_rec, ""))
-        {
-            ing_info->state = (plt::IngredientState)i;
-            player.cooking_zone = plt::CookingZone_None;
-        }
+            pending_menu_select = i;
 
-        DrawTexturePro(meals_tex, {ing_info->pos.x, ing_info->pos.y + 32.f * i, 32, 32}, fill_rec, {0.f, 0.f}, 0, WHITE);
+        Vector2 tex_pos = held.entity.get<plt::IngredientInfo>()->pos;
+        drawSprite(meals_sheet, {tex_pos.x, tex_pos.y + 32.f * i, 32, 32}, fill_rec, WHITE);
     }
 }
 
-void App::renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &player)
+void App::renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &player, const plt::HeldItem &held)
 {
+    TRACE_ZONE("App::renderStoveMenu");
+
     // Menu background
     Rectangle menu_rec = Rectangle{10.f, 10.f, screen_w - 20.f, screen_h - 20.f};
     DrawRectangleRec(menu_rec, ColorAlpha(WHITE, 0.7));
@@ -1495,12 +1886,12 @@ void App::renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &play
     // Exit Button
     setGuiTextStyle(lookout_font, ColorToInt(RED), TEXT_ALIGN_CENTER, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 4, 30);
     if (GuiButton(Rectangle{menu_rec.x + 10, menu_rec.y + 10, 100.f, 35}, "Exit"))
-        player.cooking_zone = plt::CookingZone_None;
+        pending_menu_select = plt::MenuSelect_Exit;
 
-    flecs::entity ing_e = ecs_world->get_alive(player.item);
-    plt::Ingredient *ing_info = ing_e.get_mut<plt::Ingredient>();
+    if (!held.ing)
+        return;
 
-    std::vector<std::string> cut_names = {"Left Cut", "Right Cut", "Middle Cut"};
+    static const char *cut_names[] = {"Left Cut", "Right Cut", "Middle Cut"};
 
     // Draw Cutting Options
     for (int i = plt::LeftPile; i < plt::SingleKebab; i++)
@@ -1509,14 +1900,12 @@ void App::renderStoveMenu(flecs::entity e, plt::Position &pos, plt::Player &play
         Rectangle fill_rec = {menu_rec.x + 10, menu_rec.y + 90 + 70 * (i - 1), 64, 64};
 
         setGuiTextStyle(lookout_font, ColorToInt(BLACK), TEXT_ALIGN_LEFT, TEXT_ALIGN_MIDDLE, lookout_font.baseSize / 3, 30);
-        GuiLabel({fill_rec.x + 80, fill_rec.y, 200, 64}, cut_names[i - 1].c_str());
+        GuiLabel({fill_rec.x + 80, fill_rec.y, 200, 64}, cut_names[i - 1]);
 
         if (GuiButton(fill_rec, ""))
-        {
-            ing_info->state = (plt::IngredientState)i;
-            player.cooking_zone = plt::CookingZone_None;
-        }
+            pending_menu_select = i;
 
-        DrawTexturePro(meals_tex, {ing_info->pos.x, ing_info->pos.y + 32.f * i, 32, 32}, fill_rec, {0.f, 0.f}, 0, WHITE);
+        Vector2 tex_pos = held.entity.get<plt::IngredientInfo>()->pos;
+        drawSprite(meals_sheet, {tex_pos.x, tex_pos.y + 32.f * i, 32, 32}, fill_rec, WHITE);
     }
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "FrameArena.hpp"
+#include <stdarg.h>
+
+FrameArena::FrameArena(size_t capacity)
+{
+    block.resize(capacity);
+    used = 0;
+}
+
+void FrameArena::reset()
+{
+    used = 0;
+}
+
+void *FrameArena::alloc(size_t size, size_t align)
+{
+    size_t start = (used + align - 1) & ~(align - 1);
+    assert(start + size <= block.size());
+
+    used = start + size;
+    return block.data() + start;
+}
+
+const char *FrameArena::format(const char *fmt, ...)
+{
+    va_list args;
+
+    // Measure first so labels of any length fit without a fixed per-string limit
+    va_start(args, fmt);
+    int length = vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+
+    if (length < 0)
+        return "";
+
+    char *text = (char *)alloc(length + 1, 1);
+
+    va_start(args, fmt);
+    vsnprintf(text, length + 1, fmt, args);
+    va_end(args);
+
+    return text;
+}
+
+size_t FrameArena::getUsed() const
+{
+    return used;
+}
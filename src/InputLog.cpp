@@ -0,0 +1,216 @@
+#include "InputLog.hpp"
+
+InputLog::InputLog(uint64_t seed, int sim_hz)
+{
+    this->seed = seed;
+    this->sim_hz = sim_hz;
+    tick_count = 0;
+
+    rewind();
+}
+
+InputLogRecord InputLog::pack(const plt::InputState &input)
+{
+    InputLogRecord record = {};
+    record.run = 1;
+
+    record.flags = (input.up ? InputLogFlag_Up : 0) |
+                   (input.down ? InputLogFlag_Down : 0) |
+                   (input.left ? InputLogFlag_Left : 0) |
+                   (input.right ? InputLogFlag_Right : 0) |
+                   (input.interact ? InputLogFlag_Interact : 0) |
+                   (input.advance ? InputLogFlag_Advance : 0) |
+                   (input.mouse_left ? InputLogFlag_MouseLeft : 0);
+
+    // Menus have a handful of options, plus the negative MenuSelect values
+    record.menu_select = (int8_t)input.menu_select;
+
+    // Whole pixels are plenty, the mouse only picks menu buttons
+    record.mouse_x = (int16_t)std::round(input.mouse.x);
+    record.mouse_y = (int16_t)std::round(input.mouse.y);
+
+    return record;
+}
+
+plt::InputState InputLog::unpack(const InputLogRecord &record)
+{
+    plt::InputState input = {};
+
+    input.up = record.flags & InputLogFlag_Up;
+    input.down = record.flags & InputLogFlag_Down;
+    input.left = record.flags & InputLogFlag_Left;
+    input.right = record.flags & InputLogFlag_Right;
+    input.interact = record.flags & InputLogFlag_Interact;
+    input.advance = record.flags & InputLogFlag_Advance;
+    input.mouse_left = record.flags & InputLogFlag_MouseLeft;
+
+    input.menu_select = record.menu_select;
+    input.mouse = Vector2{(float)record.mouse_x, (float)record.mouse_y};
+
+    return input;
+}
+
+void InputLog::record(const plt::InputState &input)
+{
+    InputLogRecord packed = pack(input);
+    tick_count++;
+
+    // Extend the last run if nothing changed
+    if (!records.empty())
+    {
+        InputLogRecord &last = records.back();
+
+        if (last.run < UINT16_MAX && last.flags == packed.flags && last.menu_select == packed.menu_select &&
+            last.mouse_x == packed.mouse_x && last.mouse_y == packed.mouse_y)
+        {
+            last.run++;
+            return;
+        }
+    }
+
+    records.push_back(packed);
+}
+
+bool InputLog::save(const char *path) const
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        printf("input log: can't open %s\n", path);
+        return false;
+    }
+
+    InputLogHeader header = {};
+    header.magic = InputLog_Magic;
+    header.version = InputLog_Version;
+    header.sim_hz = sim_hz;
+    header.tick_count = tick_count;
+    header.seed = seed;
+    header.record_count = records.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !records.empty())
+        ok = fwrite(records.data(), sizeof(InputLogRecord), records.size(), file) == records.size();
+
+    fclose(file);
+
+    if (ok)
+        printf("input log: wrote %d ticks (%zu bytes) to %s\n", tick_count, getByteSize(), path);
+
+    return ok;
+}
+
+bool InputLog::load(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("input log: can't open %s\n", path);
+        return false;
+    }
+
+    InputLogHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != InputLog_Magic || header.version != InputLog_Version)
+    {
+        printf("input log: %s is not a version %u input log\n", path, InputLog_Version);
+        fclose(file);
+        return false;
+    }
+
+    // The log replays through the fixed-step loop at its recorded rate
+    if (header.sim_hz < (uint32_t)App_MinSimHz || header.sim_hz > (uint32_t)App_MaxSimHz)
+    {
+        printf("input log: %s was recorded at %u Hz, only %d-%d Hz can be replayed\n", path, header.sim_hz, App_MinSimHz, App_MaxSimHz);
+        fclose(file);
+        return false;
+    }
+
+    // The header's record count has to match what's actually left in the file before anything is allocated
+    long records_start = ftell(file);
+    bool sized = records_start >= 0 && fseek(file, 0, SEEK_END) == 0;
+    long file_end = sized ? ftell(file) : -1;
+    sized = sized && file_end >= records_start && fseek(file, records_start, SEEK_SET) == 0;
+
+    if (!sized || (uint64_t)header.record_count * sizeof(InputLogRecord) != (uint64_t)(file_end - records_start))
+    {
+        printf("input log: %s doesn't hold the %u records its header lists\n", path, header.record_count);
+        fclose(file);
+        return false;
+    }
+
+    std::vector<InputLogRecord> loaded(header.record_count);
+    bool ok = fread(loaded.data(), sizeof(InputLogRecord), loaded.size(), file) == loaded.size();
+    fclose(file);
+
+    if (!ok)
+    {
+        printf("input log: %s is truncated\n", path);
+        return false;
+    }
+
+    // Every record covers at least one tick, together exactly the ticks the header lists
+    bool runs_valid = header.tick_count <= INT32_MAX;
+    uint64_t run_ticks = 0;
+
+    for (auto &record : loaded)
+    {
+        runs_valid = runs_valid && record.run > 0;
+        run_ticks += record.run;
+    }
+
+    if (!runs_valid || run_ticks != header.tick_count)
+    {
+        printf("input log: %s has runs that don't add up to its %u ticks\n", path, header.tick_count);
+        return false;
+    }
+
+    records = std::move(loaded);
+    seed = header.seed;
+    sim_hz = header.sim_hz;
+    tick_count = header.tick_count;
+
+    rewind();
+    return true;
+}
+
+void InputLog::rewind()
+{
+    replay_record = 0;
+    replay_run = 0;
+}
+
+bool InputLog::nextInput(plt::InputState &out)
+{
+    if (replay_record >= records.size())
+        return false;
+
+    out = unpack(records[replay_record]);
+
+    if (++replay_run >= records[replay_record].run)
+    {
+        replay_record++;
+        replay_run = 0;
+    }
+
+    return true;
+}
+
+uint64_t InputLog::getSeed() const
+{
+    return seed;
+}
+
+int InputLog::getSimHz() const
+{
+    return sim_hz;
+}
+
+int InputLog::getTickCount() const
+{
+    return tick_count;
+}
+
+size_t InputLog::getByteSize() const
+{
+    return sizeof(InputLogHeader) + records.size() * sizeof(InputLogRecord);
+}
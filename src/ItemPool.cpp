@@ -0,0 +1,75 @@
+#include "ItemPool.hpp"
+
+ItemPool::ItemPool()
+{
+    free_count = 0;
+    live_count = 0;
+    acquire_count = 0;
+    hit_count = 0;
+}
+
+flecs::entity ItemPool::acquire(const flecs::world &world, flecs::entity_t prefab)
+{
+    acquire_count++;
+    live_count++;
+
+    std::vector<flecs::entity_t> &free_list = free_items[prefab];
+
+    if (free_list.empty())
+        return world.entity().is_a(prefab);
+
+    hit_count++;
+    free_count--;
+
+    flecs::entity item = world.get_alive(free_list.back());
+    free_list.pop_back();
+
+    return item;
+}
+
+flecs::entity ItemPool::acquireIngredient(const flecs::world &world, flecs::entity_t prefab, plt::Ingredient ing)
+{
+    flecs::entity item = acquire(world, prefab);
+    item.set<plt::Ingredient>(ing);
+    return item;
+}
+
+flecs::entity ItemPool::acquireDish(const flecs::world &world, flecs::entity_t prefab, plt::Dish dish)
+{
+    flecs::entity item = acquire(world, prefab);
+    item.set<plt::Dish>(dish);
+    return item;
+}
+
+void ItemPool::release(flecs::entity item)
+{
+    flecs::entity prefab = item.target(flecs::IsA);
+    assert(prefab);
+
+    live_count--;
+    free_count++;
+    free_items[prefab.id()].push_back(item.id());
+}
+
+int ItemPool::getLiveCount() const
+{
+    return live_count;
+}
+
+int ItemPool::getFreeCount() const
+{
+    return free_count;
+}
+
+uint32_t ItemPool::getAcquireCount() const
+{
+    return acquire_count;
+}
+
+float ItemPool::getHitRate() const
+{
+    if (acquire_count == 0)
+        return 0.f;
+
+    return (float)hit_count / acquire_count;
+}
@@ -0,0 +1,16 @@
+#include "main.hpp"
+
+// Single-header library implementations, compiled once for the game and the benchmarks
+
+// Immediate-mode GUI Library
+#define RAYGUI_IMPLEMENTATION
+#define GLSL_VERSION 330
+#include "raygui.h"
+
+// Tiled loader
+#define CUTE_TILED_IMPLEMENTATION
+#include "cute_tiled.h"
+
+// Collision
+#define CUTE_C2_IMPLEMENTATION
+#include "cute_c2.hpp"
@@ -1,109 +1,351 @@
 #include "Map.hpp"
+#include "rlgl.h"
 
-Map::Map(flecs::world *ecs_world)
+// Memory-mapped baked maps
+#if defined(__unix__) || defined(__APPLE__) || defined(__EMSCRIPTEN__)
+#define MAP_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Tile shader: resolves each fragment's tile through the layer's index texture (texture0)
+//  - The bound tilesets are slots 0-3, slot_tileset holds the tileset index bound to each slot (-1 unbound)
+//  - slot_info: tileset columns, texture width, texture height
+//  - Index texels: local tile id in rgb (24 bits, MapBin_MaxGid fits), tileset index + 1 in a
+#ifdef __EMSCRIPTEN__
+static const char *tile_shader_header = "#version 100\n"
+                                        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+                                        "precision highp float;\n"
+                                        "#else\n"
+                                        "precision mediump float;\n"
+                                        "#endif\n"
+                                        "#define IN varying\n"
+                                        "#define TEXTURE texture2D\n"
+                                        "#define FRAG_COLOR gl_FragColor\n";
+#else
+static const char *tile_shader_header = "#version 330\n"
+                                        "#define IN in\n"
+                                        "#define TEXTURE texture\n"
+                                        "out vec4 finalColor;\n"
+                                        "#define FRAG_COLOR finalColor\n";
+#endif
+
+static const char *tile_shader_body = R"(
+IN vec2 fragTexCoord;
+IN vec4 fragColor;
+
+uniform sampler2D texture0;
+uniform sampler2D tileset0;
+uniform sampler2D tileset1;
+uniform sampler2D tileset2;
+uniform sampler2D tileset3;
+
+uniform vec2 map_size;
+uniform vec2 tile_size;
+uniform vec4 slot_tileset;
+uniform vec4 slot_info[4];
+
+void main()
+{
+    vec2 tile_pos = fragTexCoord * map_size;
+    vec4 index = TEXTURE(texture0, (floor(tile_pos) + 0.5) / map_size);
+
+    float tileset = floor(index.a * 255.0 + 0.5) - 1.0;
+    float local_id = floor(index.r * 255.0 + 0.5) + floor(index.g * 255.0 + 0.5) * 256.0 + floor(index.b * 255.0 + 0.5) * 65536.0;
+
+    vec4 info;
+    if (tileset < 0.0)
+        discard;
+    else if (tileset == slot_tileset.x)
+        info = slot_info[0];
+    else if (tileset == slot_tileset.y)
+        info = slot_info[1];
+    else if (tileset == slot_tileset.z)
+        info = slot_info[2];
+    else if (tileset == slot_tileset.w)
+        info = slot_info[3];
+    else
+        discard;
+
+    vec2 cell = vec2(mod(local_id, info.x), floor(local_id / info.x));
+    vec2 uv = (cell + fract(tile_pos)) * tile_size / info.yz;
+
+    vec4 color;
+    if (tileset == slot_tileset.x)
+        color = TEXTURE(tileset0, uv);
+    else if (tileset == slot_tileset.y)
+        color = TEXTURE(tileset1, uv);
+    else if (tileset == slot_tileset.z)
+        color = TEXTURE(tileset2, uv);
+    else
+        color = TEXTURE(tileset3, uv);
+
+    FRAG_COLOR = color * fragColor;
+}
+)";
+
+Map::Map(flecs::world *ecs_world, bool headless, SpriteAtlas *atlas)
 {
     //--------------------------------------------------------------------------------------
     // Set ECS World for adding map objects
     //--------------------------------------------------------------------------------------
     this->ecs_world = ecs_world;
+    this->headless = headless;
+    this->atlas = atlas;
+
+    baked_data = nullptr;
+    baked_size = 0;
+    baked_is_mapped = false;
+    map = nullptr;
+
+    chunks_w = 0;
+    chunks_h = 0;
+    max_baked_chunks = 0;
+    frame_index = 0;
+
+    render_mode = MapRenderMode_Chunks;
+    tile_shader = {};
 
     //--------------------------------------------------------------------------------------
-    // Parse Map
+    // Load Map (baked binary if there is one, Tiled JSON otherwise)
     //--------------------------------------------------------------------------------------
-    map = cute_tiled_load_map_from_file("speedjam5map.json", NULL);
+    if (!loadBaked("speedjam5map.bin"))
+        loadTiled("speedjam5map.json");
+
+    // Entities are all in place, the rest needs a GPU
+    if (headless)
+        return;
 
     //--------------------------------------------------------------------------------------
-    // Load Tileset Textures
+    // Find the tilesets in the sprite atlas (the atlas owns every tile texture)
     //--------------------------------------------------------------------------------------
-    cute_tiled_tileset_t *ts_ptr = map->tilesets;
-    while (ts_ptr)
+    for (auto &ts_info : tilesets_info)
     {
-        // Get the tileset image's path
-        std::filesystem::path ts_path(ts_ptr->image.ptr);
+        ts_info.atlas_source = atlas->getSource(ts_info.image);
+        ts_info.tex = {};
+    }
 
-        // Load tileset's image
-        Image ts_img = LoadImage(ts_path.filename().string().c_str());
-        TilesetInfo ts_info;
-        ts_info.info = *ts_ptr;
+    //--------------------------------------------------------------------------------------
+    // Split the map into chunks, they're baked the first time they're drawn (or prefetched).
+    // Front layers become a list of tiles for the sprite batch instead
+    //--------------------------------------------------------------------------------------
+    buildGidTable();
+    buildFrontTiles();
+    initChunks();
+}
 
-        // Load texture
-        ts_info.tex = LoadTextureFromImage(ts_img);
-        UnloadImage(ts_img);
+Map::~Map()
+{
+    if (!headless)
+    {
+        for (auto &target : chunk_targets)
+            UnloadRenderTexture(target);
 
-        // Add to tilesets
-        tilesets_info.push_back(ts_info);
+        for (auto &index_layer : index_layers)
+        {
+            if (index_layer.index_tex.id > 0)
+                UnloadTexture(index_layer.index_tex);
+        }
 
-        // Go onto next tileset
-        ts_ptr = ts_ptr->next;
+        if (tile_shader.id > 0)
+            UnloadShader(tile_shader);
     }
 
+    unloadBaked();
+
+    if (map)
+        cute_tiled_free_map(map);
+}
+
+//--------------------------------------------------------------------------------------
+// Baked binary map
+//--------------------------------------------------------------------------------------
+bool Map::loadBaked(const char *path)
+{
+    if (!FileExists(path))
+        return false;
+
+#ifdef MAP_USE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            baked_data = (uint8_t *)mapped;
+            baked_size = file_stat.st_size;
+            baked_is_mapped = true;
+        }
+    }
+    close(fd);
+#endif
+
+    // Platforms without mmap read the file into memory once
+    if (!baked_data)
+    {
+        int data_size = 0;
+        baked_data = LoadFileData(path, &data_size);
+        baked_size = data_size;
+    }
+
+    if (!baked_data)
+        return false;
+
     //--------------------------------------------------------------------------------------
-    // Get map basic data
+    // Validate the header and section bounds before trusting anything in the file
     //--------------------------------------------------------------------------------------
-    int map_w = map->width;
-    int map_h = map->height;
+    if (baked_size < sizeof(plt::MapBinHeader))
+    {
+        TraceLog(LOG_WARNING, "MAP: %s is too small for a baked map header, falling back to JSON", path);
+        unloadBaked();
+        return false;
+    }
+
+    const plt::MapBinHeader *header = (const plt::MapBinHeader *)baked_data;
+
+    auto section_fits = [&](uint32_t offset, uint64_t count, size_t elem_size)
+    {
+        return offset % 4 == 0 && offset + count * elem_size <= baked_size;
+    };
+
+    bool valid = header->magic == plt::MapBin_Magic &&
+                 header->version == plt::MapBin_Version &&
+                 header->file_size == baked_size &&
+                 header->map_w > 0 && header->map_h > 0 &&
+                 header->tile_w > 0 && header->tile_h > 0 &&
+                 section_fits(header->tileset_offset, header->tileset_count, sizeof(plt::MapBinTileset)) &&
+                 section_fits(header->layer_offset, header->layer_count, sizeof(plt::MapBinLayer)) &&
+                 section_fits(header->collider_offset, header->collider_count, sizeof(plt::MapBinRect)) &&
+                 section_fits(header->object_offset, header->object_count, sizeof(plt::MapBinObject));
+
+    const plt::MapBinTileset *bin_tilesets = (const plt::MapBinTileset *)(baked_data + header->tileset_offset);
+    const plt::MapBinLayer *bin_layers = (const plt::MapBinLayer *)(baked_data + header->layer_offset);
+
+    // The GID table is indexed with firstgid + local tile id, GID 0 is the empty tile
+    for (uint32_t i = 0; valid && i < header->tileset_count; i++)
+    {
+        const plt::MapBinTileset &ts = bin_tilesets[i];
+        valid = ts.firstgid > 0 && ts.tilecount >= 0 && ts.columns > 0 &&
+                (int64_t)ts.firstgid + ts.tilecount <= plt::MapBin_MaxGid;
+    }
+
+    for (uint32_t i = 0; valid && i < header->layer_count; i++)
+        valid = section_fits(bin_layers[i].data_offset, (uint64_t)header->map_w * header->map_h, sizeof(int32_t));
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "MAP: %s is not a valid baked map (version %u expected), falling back to JSON", path, plt::MapBin_Version);
+        unloadBaked();
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Use the sections in place
+    //--------------------------------------------------------------------------------------
+    map_w = header->map_w;
+    map_h = header->map_h;
+    tile_w = header->tile_w;
+    tile_h = header->tile_h;
+
+    for (uint32_t i = 0; i < header->tileset_count; i++)
+    {
+        TilesetInfo ts_info;
+        ts_info.firstgid = bin_tilesets[i].firstgid;
+        ts_info.tilecount = bin_tilesets[i].tilecount;
+        ts_info.columns = bin_tilesets[i].columns;
+        ts_info.image = std::string(bin_tilesets[i].image, strnlen(bin_tilesets[i].image, sizeof(bin_tilesets[i].image)));
+        tilesets_info.push_back(ts_info);
+    }
+
+    for (uint32_t i = 0; i < header->layer_count; i++)
+        layers.push_back({(const int32_t *)(baked_data + bin_layers[i].data_offset), (bin_layers[i].flags & plt::MapBinLayer_Front) != 0});
+
+    const plt::MapBinRect *colliders = (const plt::MapBinRect *)(baked_data + header->collider_offset);
+    for (uint32_t i = 0; i < header->collider_count; i++)
+        addSolidBody(Rectangle{colliders[i].x, colliders[i].y, colliders[i].width, colliders[i].height});
+
+    const plt::MapBinObject *objects = (const plt::MapBinObject *)(baked_data + header->object_offset);
+    for (uint32_t i = 0; i < header->object_count; i++)
+        addMapObject(objects[i].kind, Rectangle{objects[i].rect.x, objects[i].rect.y, objects[i].rect.width, objects[i].rect.height});
 
-    int tile_w = map->tilewidth;
-    int tile_h = map->tileheight;
+    return true;
+}
+
+void Map::unloadBaked()
+{
+    if (!baked_data)
+        return;
+
+#ifdef MAP_USE_MMAP
+    if (baked_is_mapped)
+        munmap(baked_data, baked_size);
+    else
+        UnloadFileData(baked_data);
+#else
+    UnloadFileData(baked_data);
+#endif
+
+    baked_data = nullptr;
+    baked_size = 0;
+    baked_is_mapped = false;
+}
 
+//--------------------------------------------------------------------------------------
+// Tiled JSON map (fallback when no baked map exists)
+//--------------------------------------------------------------------------------------
+void Map::loadTiled(const char *path)
+{
     //--------------------------------------------------------------------------------------
-    // Initialize map rendertarget
+    // Parse Map
     //--------------------------------------------------------------------------------------
-    map_target = LoadRenderTexture(map_w * tile_w, map_h * tile_h);
-    map_target_front = LoadRenderTexture(map_w * tile_w, map_h * tile_h);
+    map = cute_tiled_load_map_from_file(path, NULL);
 
     //--------------------------------------------------------------------------------------
-    // Render map layers to RenderTexture
+    // Get map basic data
+    //--------------------------------------------------------------------------------------
+    map_w = map->width;
+    map_h = map->height;
+
+    tile_w = map->tilewidth;
+    tile_h = map->tileheight;
+
     //--------------------------------------------------------------------------------------
+    // Get Tilesets
+    //--------------------------------------------------------------------------------------
+    cute_tiled_tileset_t *ts_ptr = map->tilesets;
+    while (ts_ptr)
+    {
+        TilesetInfo ts_info;
+        ts_info.firstgid = ts_ptr->firstgid;
+        ts_info.tilecount = ts_ptr->tilecount;
+        ts_info.columns = ts_ptr->columns;
 
+        // Only the tileset image's file name is used, assets are flattened
+        ts_info.image = std::filesystem::path(ts_ptr->image.ptr).filename().string();
+
+        // Add to tilesets
+        tilesets_info.push_back(ts_info);
+
+        // Go onto next tileset
+        ts_ptr = ts_ptr->next;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Get Layers and Objects
+    //--------------------------------------------------------------------------------------
     cute_tiled_layer_t *layer = map->layers;
 
     while (layer)
     {
         if (std::string("tilelayer") == layer->type.ptr)
         {
-            int *data = layer->data;
-            int data_count = layer->data_count;
-
-            for (int column = 0; column < map_w; column++)
-            {
-                for (int row = 0; row < map_h; row++)
-                {
-                    // Get the tile num for the tile on this layer
-                    int tile_data = data[map_w * row + column];
-
-                    if (tile_data == 0)
-                        continue;
-
-                    // Determine the tile's tileset
-                    TilesetInfo *this_tile_info;
-
-                    for (auto &tile_info : tilesets_info)
-                    {
-                        if (tile_info.info.firstgid <= tile_data && tile_data <= tile_info.info.firstgid + tile_info.info.tilecount - 1)
-                        {
-                            this_tile_info = &tile_info;
-                            break;
-                        }
-                    }
-
-                    // Draw to the rendertexture
-                    Rectangle src_rect = {(float)tile_w * ((tile_data - this_tile_info->info.firstgid) % this_tile_info->info.columns),
-                                          (float)tile_h * ((tile_data - this_tile_info->info.firstgid) / this_tile_info->info.columns),
-                                          (float)tile_w,
-                                          (float)tile_h};
-
-                    Vector2 dest_pos = {(float)column * tile_w, (float)row * tile_h};
-                    
-                    if (std::string("frontlayer") == layer->class_.ptr)
-                        BeginTextureMode(map_target_front);
-                    else
-                        BeginTextureMode(map_target);
-
-                    DrawTextureRec(this_tile_info->tex, src_rect, dest_pos, WHITE);
-                    EndTextureMode();
-                }
-            }
+            layers.push_back({layer->data, layer->class_.ptr && std::string("frontlayer") == layer->class_.ptr});
         }
         else if (std::string("objectgroup") == layer->type.ptr)
         {
@@ -116,11 +358,7 @@ Map::Map(flecs::world *ecs_world)
 
                 while (layer_obj)
                 {
-                    flecs::entity solid_e = ecs_world->entity();
-                    solid_e.set<plt::Position>({layer_obj->x, layer_obj->y});
-                    solid_e.set<plt::Collider>({Rectangle{0, 0, layer_obj->width, layer_obj->height}, c2AABB{0, 0, 0, 0}});
-                    solid_e.set<plt::SolidBody>({1});
-
+                    addSolidBody(Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height});
                     layer_obj = layer_obj->next;
                 }
             }
@@ -134,53 +372,7 @@ Map::Map(flecs::world *ecs_world)
 
                 while (layer_obj)
                 {
-                    // ==================================================
-                    // Add the player at spawn
-                    // ==================================================
-                    if (std::string("Spawn") == layer_obj->name.ptr)
-                    {
-                        flecs::entity player_e = ecs_world->entity();
-                        player_e.set<plt::Position>({layer_obj->x, layer_obj->y});
-                        player_e.set<plt::Player>({false, plt::PlayerMvnmtState_Forward, 0, 0.1, 0.3, 0, flecs::Empty, plt::PlayerHoldingType_None, plt::CookingZone_None});
-                        player_e.set<plt::Collider>({Rectangle{-7, -2, 14, 8}, c2AABB{0, 0, 0, 0}});
-                        player_e.set<plt::DynamicBody>({1});
-                    }
-                    else if (std::string("Bag") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Bag, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("Dishes") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Dishes, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("Sink") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Sink, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("CuttingBoard") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_CuttingBoard, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("Stove") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Stove, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("Trash") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Trash, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-                    else if (std::string("Plating") == layer_obj->name.ptr)
-                    {
-                        flecs::entity zone_e = ecs_world->entity();
-                        zone_e.set<plt::CookingZone>({plt::CookingZone_Plating, Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height}});
-                    }
-
+                    addMapObject(plt::mapObjectKindFromName(layer_obj->name.ptr), Rectangle{layer_obj->x, layer_obj->y, layer_obj->width, layer_obj->height});
                     layer_obj = layer_obj->next;
                 }
             }
@@ -190,22 +382,640 @@ Map::Map(flecs::world *ecs_world)
     }
 }
 
-Map::~Map()
+//--------------------------------------------------------------------------------------
+// Map entities
+//--------------------------------------------------------------------------------------
+void Map::addSolidBody(Rectangle rect)
 {
-    UnloadRenderTexture(map_target);
+    flecs::entity solid_e = ecs_world->entity();
+    solid_e.set<plt::Position>({rect.x, rect.y});
+    solid_e.set<plt::Collider>({Rectangle{0, 0, rect.width, rect.height}, c2AABB{0, 0, 0, 0}});
+    solid_e.set<plt::SolidBody>({1});
+}
 
+void Map::addMapObject(plt::MapObjectKind kind, Rectangle rect)
+{
+    // ==================================================
+    // Add the player at spawn
+    // ==================================================
+    if (kind == plt::MapObject_Spawn)
+    {
+        flecs::entity player_e = ecs_world->entity();
+        player_e.set<plt::Position>({rect.x, rect.y});
+        player_e.set<plt::PrevPosition>({rect.x, rect.y});
+        player_e.set<plt::Player>({false, plt::PlayerMvnmtState_Forward, 0, 0.1, 0.3, 0, plt::PlayerHoldingType_None, plt::CookingZone_None});
+        player_e.set<plt::Collider>({Rectangle{-7, -2, 14, 8}, c2AABB{0, 0, 0, 0}});
+        player_e.set<plt::DynamicBody>({1});
+        return;
+    }
+
+    // ==================================================
+    // Add cooking zones
+    // ==================================================
+    plt::CookingZoneType zone_type = plt::CookingZone_None;
+
+    switch (kind)
+    {
+    case plt::MapObject_Bag:
+        zone_type = plt::CookingZone_Bag;
+        break;
+    case plt::MapObject_Dishes:
+        zone_type = plt::CookingZone_Dishes;
+        break;
+    case plt::MapObject_Sink:
+        zone_type = plt::CookingZone_Sink;
+        break;
+    case plt::MapObject_CuttingBoard:
+        zone_type = plt::CookingZone_CuttingBoard;
+        break;
+    case plt::MapObject_Stove:
+        zone_type = plt::CookingZone_Stove;
+        break;
+    case plt::MapObject_Trash:
+        zone_type = plt::CookingZone_Trash;
+        break;
+    case plt::MapObject_Plating:
+        zone_type = plt::CookingZone_Plating;
+        break;
+
+    default:
+        return;
+    }
+
+    flecs::entity zone_e = ecs_world->entity();
+    zone_e.set<plt::CookingZone>({zone_type, rect});
+}
+
+//--------------------------------------------------------------------------------------
+// Map baking
+//--------------------------------------------------------------------------------------
+void Map::buildGidTable()
+{
+    // GID 0 is the empty tile, every other GID maps to exactly one tileset
+    int gid_count = 1;
     for (auto &ts_info : tilesets_info)
-        UnloadTexture(ts_info.tex);
+        gid_count = std::max(gid_count, ts_info.firstgid + ts_info.tilecount);
+
+    gid_table.assign(gid_count, TileRef{-1, Texture2D{}, Rectangle{0, 0, 0, 0}});
+
+    for (int ts = 0; ts < tilesets_info.size(); ts++)
+    {
+        TilesetInfo &info = tilesets_info[ts];
+
+        for (int local_id = 0; local_id < info.tilecount; local_id++)
+        {
+            gid_table[info.firstgid + local_id] = {ts, Texture2D{}, Rectangle{(float)tile_w * (local_id % info.columns),
+                                                                              (float)tile_h * (local_id / info.columns),
+                                                                              (float)tile_w,
+                                                                              (float)tile_h}};
+        }
+    }
+
+    // Resolve only the GIDs the layers use, so unused tiles never pull in their tileset's image
+    for (auto &layer : layers)
+    {
+        for (int i = 0; i < map_w * map_h; i++)
+        {
+            int tile_data = cute_tiled_unset_flags(layer.data[i]);
+
+            if (tile_data <= 0 || tile_data >= gid_table.size())
+                continue;
+
+            TileRef &tile = gid_table[tile_data];
 
-    cute_tiled_free_map(map);
+            if (tile.tileset < 0 || tile.tex.id > 0)
+                continue;
+
+            AtlasSprite sprite = atlas->resolve(tilesets_info[tile.tileset].atlas_source, tile.src);
+            tile.tex = sprite.tex;
+            tile.src = sprite.src;
+        }
+    }
+
+    // A chunk layer never holds more than a chunk's worth of tiles, so baking doesn't allocate
+    tileset_batches.resize(tilesets_info.size());
+
+    for (auto &batch : tileset_batches)
+        batch.reserve(Map_ChunkTiles * Map_ChunkTiles);
+}
+
+void Map::buildFrontTiles()
+{
+    // Front layers in draw order
+    std::vector<const MapLayer *> front_layers;
+    for (auto &layer : layers)
+    {
+        if (layer.front)
+            front_layers.push_back(&layer);
+    }
+
+    auto tile_at = [&](const MapLayer *layer, int column, int row) -> const TileRef *
+    {
+        int tile_data = cute_tiled_unset_flags(layer->data[map_w * row + column]);
+
+        if (tile_data <= 0 || tile_data >= gid_table.size() || gid_table[tile_data].tileset < 0)
+            return nullptr;
+
+        return &gid_table[tile_data];
+    };
+
+    auto occupied = [&](int column, int row)
+    {
+        for (auto *layer : front_layers)
+        {
+            if (tile_at(layer, column, row))
+                return true;
+        }
+        return false;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Every tile in a vertical run of front tiles sorts at the bottom of the run, so a
+    // piece of furniture is in front of the chef while they stand behind its base
+    //--------------------------------------------------------------------------------------
+    for (int column = 0; column < map_w; column++)
+    {
+        int row = 0;
+        while (row < map_h)
+        {
+            if (!occupied(column, row))
+            {
+                row++;
+                continue;
+            }
+
+            int run_end = row;
+            while (run_end < map_h && occupied(column, run_end))
+                run_end++;
+
+            float base_y = (float)run_end * tile_h;
+
+            for (; row < run_end; row++)
+            {
+                for (int l = 0; l < front_layers.size(); l++)
+                {
+                    const TileRef *tile = tile_at(front_layers[l], column, row);
+                    if (!tile)
+                        continue;
+
+                    // SpriteBatch keeps quarter pixels of y, enough to keep later layers over earlier ones
+                    front_tiles.push_back({tile->tex, tile->src, Vector2{(float)column * tile_w, (float)row * tile_h}, base_y + l * 0.25f});
+                }
+            }
+        }
+    }
+}
+
+void Map::initChunks()
+{
+    chunks_w = (map_w + Map_ChunkTiles - 1) / Map_ChunkTiles;
+    chunks_h = (map_h + Map_ChunkTiles - 1) / Map_ChunkTiles;
+
+    chunks.assign(chunks_w * chunks_h, MapChunk{false, -1, 0});
+
+    // One pass over the back layers to find which chunks have anything to draw
+    for (auto &layer : layers)
+    {
+        if (layer.front)
+            continue;
+
+        for (int row = 0; row < map_h; row++)
+        {
+            for (int column = 0; column < map_w; column++)
+            {
+                int tile_data = cute_tiled_unset_flags(layer.data[map_w * row + column]);
+
+                if (tile_data <= 0 || tile_data >= gid_table.size() || gid_table[tile_data].tileset < 0)
+                    continue;
+
+                chunks[(row / Map_ChunkTiles) * chunks_w + column / Map_ChunkTiles].has_tiles = true;
+            }
+        }
+    }
+
+    // One RGBA target per baked chunk
+    size_t chunk_bytes = (size_t)(Map_ChunkTiles * tile_w) * (Map_ChunkTiles * tile_h) * 4;
+    max_baked_chunks = std::max((int)(Map_ChunkBudgetBytes / chunk_bytes), 1);
+
+    // The target pool only goes past the budget while everything baked is on screen, it never
+    // needs more targets than there are chunks to bake: streaming chunks in doesn't allocate
+    int tiled_chunks = 0;
+    for (auto &chunk : chunks)
+        tiled_chunks += chunk.has_tiles;
+
+    chunk_targets.reserve(tiled_chunks);
+    target_owners.reserve(tiled_chunks);
+}
+
+bool Map::getChunkRange(Rectangle view, int &min_cx, int &min_cy, int &max_cx, int &max_cy) const
+{
+    float chunk_px_w = (float)Map_ChunkTiles * tile_w;
+    float chunk_px_h = (float)Map_ChunkTiles * tile_h;
+
+    min_cx = std::max((int)std::floor(view.x / chunk_px_w), 0);
+    min_cy = std::max((int)std::floor(view.y / chunk_px_h), 0);
+    max_cx = std::min((int)std::ceil((view.x + view.width) / chunk_px_w) - 1, chunks_w - 1);
+    max_cy = std::min((int)std::ceil((view.y + view.height) / chunk_px_h) - 1, chunks_h - 1);
+
+    return min_cx <= max_cx && min_cy <= max_cy;
+}
+
+int Map::acquireTargets()
+{
+    int chunk_px_w = Map_ChunkTiles * tile_w;
+    int chunk_px_h = Map_ChunkTiles * tile_h;
+
+    // Least recently drawn chunk that isn't on screen this frame
+    int lru = -1;
+
+    if (chunk_targets.size() >= max_baked_chunks)
+    {
+        for (int t = 0; t < chunk_targets.size(); t++)
+        {
+            const MapChunk &owner = chunks[target_owners[t]];
+
+            if (owner.last_used == frame_index)
+                continue;
+
+            if (lru < 0 || owner.last_used < chunks[target_owners[lru]].last_used)
+                lru = t;
+        }
+    }
+
+    if (lru >= 0)
+    {
+        chunks[target_owners[lru]].targets = -1;
+        return lru;
+    }
+
+    // Under budget, or everything baked is on screen (going over budget beats re-baking every frame)
+    chunk_targets.push_back(LoadRenderTexture(chunk_px_w, chunk_px_h));
+    target_owners.push_back(-1);
+
+    return chunk_targets.size() - 1;
+}
+
+void Map::ensureBaked(int chunk_index)
+{
+    MapChunk &chunk = chunks[chunk_index];
+
+    if (chunk.targets >= 0)
+        return;
+
+    chunk.targets = acquireTargets();
+    target_owners[chunk.targets] = chunk_index;
+
+    bakeChunk(chunk_index);
+}
+
+void Map::bakeLayerChunk(const MapLayer &layer, int cx, int cy)
+{
+    //--------------------------------------------------------------------------------------
+    // Bucket the chunk's tiles on this layer by tileset
+    //--------------------------------------------------------------------------------------
+    for (auto &batch : tileset_batches)
+        batch.clear();
+
+    int min_row = cy * Map_ChunkTiles;
+    int min_column = cx * Map_ChunkTiles;
+    int max_row = std::min(min_row + Map_ChunkTiles, map_h);
+    int max_column = std::min(min_column + Map_ChunkTiles, map_w);
+
+    for (int row = min_row; row < max_row; row++)
+    {
+        for (int column = min_column; column < max_column; column++)
+        {
+            // Get the tile num for the tile on this layer
+            int tile_data = cute_tiled_unset_flags(layer.data[map_w * row + column]);
+
+            if (tile_data <= 0 || tile_data >= gid_table.size())
+                continue;
+
+            TileRef &tile = gid_table[tile_data];
+
+            if (tile.tileset < 0)
+                continue;
+
+            // Positioned relative to the chunk's corner
+            tileset_batches[tile.tileset].push_back({tile.tex, tile.src, Vector2{(float)(column - min_column) * tile_w, (float)(row - min_row) * tile_h}});
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Draw one texture at a time (the target is already in texture mode)
+    //--------------------------------------------------------------------------------------
+    for (int ts = 0; ts < tileset_batches.size(); ts++)
+    {
+        for (auto &tile : tileset_batches[ts])
+            DrawTextureRec(tile.tex, tile.src, tile.dest, WHITE);
+    }
+}
+
+void Map::bakeChunk(int chunk_index)
+{
+    TRACE_ZONE("Map::bakeChunk");
+
+    const MapChunk &chunk = chunks[chunk_index];
+
+    int cx = chunk_index % chunks_w;
+    int cy = chunk_index / chunks_w;
+
+    // Front layers are queued as sprites, only the layers behind them are baked.
+    // The target may be reused from an evicted chunk, so it's cleared first
+    BeginTextureMode(chunk_targets[chunk.targets]);
+    ClearBackground(BLANK);
+
+    for (auto &layer : layers)
+    {
+        if (!layer.front)
+            bakeLayerChunk(layer, cx, cy);
+    }
+
+    EndTextureMode();
+}
+
+void Map::drawChunks(Rectangle view)
+{
+    int min_cx, min_cy, max_cx, max_cy;
+    if (!getChunkRange(view, min_cx, min_cy, max_cx, max_cy))
+        return;
+
+    float chunk_px_w = (float)Map_ChunkTiles * tile_w;
+    float chunk_px_h = (float)Map_ChunkTiles * tile_h;
+
+    for (int cy = min_cy; cy <= max_cy; cy++)
+    {
+        for (int cx = min_cx; cx <= max_cx; cx++)
+        {
+            int chunk_index = cy * chunks_w + cx;
+            MapChunk &chunk = chunks[chunk_index];
+
+            if (!chunk.has_tiles)
+                continue;
+
+            chunk.last_used = frame_index;
+            ensureBaked(chunk_index);
+
+            const RenderTexture2D &target = chunk_targets[chunk.targets];
+            DrawTextureRec(target.texture, Rectangle{0, 0, (float)target.texture.width, (float)-target.texture.height}, Vector2{cx * chunk_px_w, cy * chunk_px_h}, WHITE);
+        }
+    }
+}
+
+Rectangle Map::getBounds() const
+{
+    return Rectangle{0, 0, (float)map_w * tile_w, (float)map_h * tile_h};
+}
+
+void Map::prefetch(Rectangle view)
+{
+    if (headless)
+        return;
+
+    int min_cx, min_cy, max_cx, max_cy;
+    if (!getChunkRange(view, min_cx, min_cy, max_cx, max_cy))
+        return;
+
+    for (int cy = min_cy; cy <= max_cy; cy++)
+    {
+        for (int cx = min_cx; cx <= max_cx; cx++)
+        {
+            MapChunk &chunk = chunks[cy * chunks_w + cx];
+
+            if (!chunk.has_tiles)
+                continue;
+
+            chunk.last_used = frame_index;
+            ensureBaked(cy * chunks_w + cx);
+        }
+    }
+}
+
+void Map::draw(Rectangle view)
+{
+    TRACE_ZONE("Map::draw");
+
+    // A new frame, chunks drawn from here on count as in use
+    frame_index++;
+
+    if (render_mode == MapRenderMode_Shader)
+        drawIndexLayers();
+    else
+        drawChunks(view);
+}
+
+void Map::queueFront(SpriteBatch &batch, Rectangle view) const
+{
+    for (auto &tile : front_tiles)
+    {
+        if (!CheckCollisionRecs(view, Rectangle{tile.dest.x, tile.dest.y, (float)tile_w, (float)tile_h}))
+            continue;
+
+        batch.add(tile.tex, tile.src, tile.dest, WHITE, tile.y_level);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Shader tilemap
+//--------------------------------------------------------------------------------------
+// Index texel of a tile (see tile_shader_body), 0 is an empty tile
+static uint32_t packIndexTexel(uint32_t local_id, int tileset)
+{
+    return (local_id & 0xFFFFFF) | ((uint32_t)(tileset + 1) << 24);
+}
+
+bool Map::initShaderLayers()
+{
+    // The index texels hold the tileset index + 1 in one byte
+    if (tilesets_info.size() > 254)
+    {
+        TraceLog(LOG_WARNING, "MAP: %d tilesets is more than the tile shader can index, keeping baked chunks", (int)tilesets_info.size());
+        return false;
+    }
+
+    std::string code = std::string(tile_shader_header) + tile_shader_body;
+    tile_shader = LoadShaderFromMemory(nullptr, code.c_str());
+
+    // raylib hands back its default shader when compiling fails
+    if (tile_shader.id == 0 || tile_shader.id == rlGetShaderIdDefault())
+    {
+        TraceLog(LOG_WARNING, "MAP: tile shader unavailable, keeping baked chunks");
+        tile_shader = {};
+        return false;
+    }
+
+    // The shader indexes the tilesets by grid position, so it needs the original images
+    for (auto &ts_info : tilesets_info)
+        ts_info.tex = atlas->getSourceTexture(ts_info.atlas_source);
+
+    tile_shader_map_size_loc = GetShaderLocation(tile_shader, "map_size");
+    tile_shader_tile_size_loc = GetShaderLocation(tile_shader, "tile_size");
+    tile_shader_slot_tileset_loc = GetShaderLocation(tile_shader, "slot_tileset");
+    tile_shader_slot_info_loc = GetShaderLocation(tile_shader, "slot_info");
+
+    for (int slot = 0; slot < Map_ShaderTilesets; slot++)
+        tile_shader_slot_tex_locs[slot] = GetShaderLocation(tile_shader, TextFormat("tileset%d", slot));
+
+    //--------------------------------------------------------------------------------------
+    // One index texture per back layer, plus the tilesets it needs bound.
+    // Front layers keep an empty entry so setTile's layer indices line up with the map's
+    //--------------------------------------------------------------------------------------
+    for (auto &layer : layers)
+    {
+        MapIndexLayer index_layer = {};
+
+        if (layer.front)
+        {
+            index_layers.push_back(std::move(index_layer));
+            continue;
+        }
+
+        index_layer.texels.assign(map_w * map_h, 0);
+
+        std::vector<bool> uses_tileset(tilesets_info.size(), false);
+
+        for (int i = 0; i < map_w * map_h; i++)
+        {
+            int tile_data = cute_tiled_unset_flags(layer.data[i]);
+
+            if (tile_data <= 0 || tile_data >= gid_table.size() || gid_table[tile_data].tileset < 0)
+                continue;
+
+            int ts = gid_table[tile_data].tileset;
+            uint32_t local_id = tile_data - tilesets_info[ts].firstgid;
+
+            index_layer.texels[i] = packIndexTexel(local_id, ts);
+            uses_tileset[ts] = true;
+        }
+
+        for (int ts = 0; ts < tilesets_info.size(); ts++)
+        {
+            if (uses_tileset[ts])
+                index_layer.tilesets.push_back(ts);
+        }
+
+        Image index_img = {index_layer.texels.data(), map_w, map_h, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        index_layer.index_tex = LoadTextureFromImage(index_img);
+        SetTextureFilter(index_layer.index_tex, TEXTURE_FILTER_POINT);
+        SetTextureWrap(index_layer.index_tex, TEXTURE_WRAP_CLAMP);
+
+        index_layers.push_back(std::move(index_layer));
+    }
+
+    Vector2 map_size = {(float)map_w, (float)map_h};
+    Vector2 tile_size = {(float)tile_w, (float)tile_h};
+    SetShaderValue(tile_shader, tile_shader_map_size_loc, &map_size, SHADER_UNIFORM_VEC2);
+    SetShaderValue(tile_shader, tile_shader_tile_size_loc, &tile_size, SHADER_UNIFORM_VEC2);
+
+    return true;
+}
+
+void Map::drawIndexLayers()
+{
+    Rectangle src = {0, 0, (float)map_w, (float)map_h};
+    Rectangle dest = getBounds();
+
+    BeginShaderMode(tile_shader);
+
+    for (auto &index_layer : index_layers)
+    {
+        if (index_layer.index_tex.id == 0)
+            continue;
+
+        // One quad per group of tilesets, usually just one
+        for (int first = 0; first < index_layer.tilesets.size(); first += Map_ShaderTilesets)
+        {
+            float slot_tileset[Map_ShaderTilesets];
+            float slot_info[Map_ShaderTilesets][4] = {};
+
+            for (int slot = 0; slot < Map_ShaderTilesets; slot++)
+            {
+                int ts = first + slot < index_layer.tilesets.size() ? index_layer.tilesets[first + slot] : -1;
+                slot_tileset[slot] = ts;
+
+                // Unused slots still need a texture bound, they're never sampled
+                const TilesetInfo &info = tilesets_info[ts >= 0 ? ts : index_layer.tilesets[first]];
+                slot_info[slot][0] = info.columns;
+                slot_info[slot][1] = info.tex.width;
+                slot_info[slot][2] = info.tex.height;
+
+                SetShaderValueTexture(tile_shader, tile_shader_slot_tex_locs[slot], info.tex);
+            }
+
+            SetShaderValue(tile_shader, tile_shader_slot_tileset_loc, slot_tileset, SHADER_UNIFORM_VEC4);
+            SetShaderValueV(tile_shader, tile_shader_slot_info_loc, slot_info, SHADER_UNIFORM_VEC4, Map_ShaderTilesets);
+
+            DrawTexturePro(index_layer.index_tex, src, dest, Vector2{0, 0}, 0, WHITE);
+
+            // Uniforms and extra textures change per quad, flush before the next one
+            rlDrawRenderBatchActive();
+        }
+    }
+
+    EndShaderMode();
+}
+
+bool Map::setRenderMode(MapRenderMode mode)
+{
+    if (headless)
+        return false;
+
+    if (mode == MapRenderMode_Shader && index_layers.empty() && !initShaderLayers())
+        return false;
+
+    render_mode = mode;
+    return true;
+}
+
+MapRenderMode Map::getRenderMode() const
+{
+    return render_mode;
+}
+
+bool Map::setTile(int layer_index, int column, int row, int gid)
+{
+    if (render_mode != MapRenderMode_Shader || layer_index < 0 || layer_index >= index_layers.size() ||
+        column < 0 || column >= map_w || row < 0 || row >= map_h)
+        return false;
+
+    MapIndexLayer &index_layer = index_layers[layer_index];
+    if (index_layer.index_tex.id == 0)
+        return false;
+
+    uint32_t &texel = index_layer.texels[row * map_w + column];
+
+    gid = cute_tiled_unset_flags(gid);
+
+    if (gid <= 0 || gid >= gid_table.size() || gid_table[gid].tileset < 0)
+    {
+        texel = 0;
+    }
+    else
+    {
+        int ts = gid_table[gid].tileset;
+
+        // The layer's quads only bind the tilesets it already uses
+        if (std::find(index_layer.tilesets.begin(), index_layer.tilesets.end(), ts) == index_layer.tilesets.end())
+            index_layer.tilesets.push_back(ts);
+
+        texel = packIndexTexel(gid - tilesets_info[ts].firstgid, ts);
+    }
+
+    UpdateTextureRec(index_layer.index_tex, Rectangle{(float)column, (float)row, 1, 1}, &texel);
+    return true;
+}
+
+int Map::getChunkCount() const
+{
+    return chunks.size();
 }
 
-void Map::draw()
+int Map::getBakedChunkCount() const
 {
-    DrawTextureRec(map_target.texture, Rectangle{0, 0, (float)map_target.texture.width, (float)-map_target.texture.height}, Vector2{0, 0}, WHITE);
+    return chunk_targets.size();
 }
 
-void Map::drawFront()
+int Map::getFrontTileCount() const
 {
-    DrawTextureRec(map_target_front.texture, Rectangle{0, 0, (float)map_target.texture.width, (float)-map_target.texture.height}, Vector2{0, 0}, WHITE);
+    return front_tiles.size();
 }
@@ -0,0 +1,191 @@
+#include "Profiler.hpp"
+
+static const char *slot_names[ProfileSlot_Count] = {
+    "SnapshotSystem",
+    "PlayerSystem",
+    "CollisionSystem",
+    "DynamicBodySystem",
+    "CustomerSystem",
+    "GameStateSystem",
+    "RenderSystem",
+};
+
+Profiler::Profiler(int window_frames)
+{
+    visible = false;
+
+    frame_times.assign(window_frames, 0.f);
+    frame_head = 0;
+    frame_filled = 0;
+
+    for (int i = 0; i < ProfileSlot_Count; i++)
+    {
+        slot_times[i].assign(window_frames, 0.f);
+        slot_avg[i] = 0;
+    }
+
+    setStageCount(1);
+
+    frame_min = 0;
+    frame_avg = 0;
+    frame_p99 = 0;
+
+    sorted_scratch.reserve(window_frames);
+
+    memset(&world_stats, 0, sizeof(world_stats));
+    stats_timer = 0;
+    entity_count = 0;
+    table_count = 0;
+}
+
+void Profiler::toggle()
+{
+    visible = !visible;
+
+    // Start from a clean window so stale frames from before the toggle don't skew the numbers
+    frame_head = 0;
+    frame_filled = 0;
+    stats_timer = 0;
+
+    std::fill(stage_accum.begin(), stage_accum.end(), 0.f);
+}
+
+void Profiler::setStageCount(int n)
+{
+    stage_accum.assign(std::max(n, 1) * ProfileSlot_Count, 0.f);
+}
+
+void Profiler::addTime(ProfileSlot slot, float ms, int stage)
+{
+    stage_accum[stage * ProfileSlot_Count + slot] += ms;
+}
+
+void Profiler::endFrame(float frame_time, flecs::world &world)
+{
+    if (!visible)
+        return;
+
+    frame_times[frame_head] = frame_time * 1000.f;
+
+    int stage_count = stage_accum.size() / ProfileSlot_Count;
+
+    for (int i = 0; i < ProfileSlot_Count; i++)
+    {
+        float slot_sum = 0;
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            slot_sum += stage_accum[stage * ProfileSlot_Count + i];
+            stage_accum[stage * ProfileSlot_Count + i] = 0;
+        }
+
+        slot_times[i][frame_head] = slot_sum;
+    }
+
+    frame_head = (frame_head + 1) % frame_times.size();
+    frame_filled = std::min(frame_filled + 1, (int)frame_times.size());
+
+    refreshAggregates();
+
+    stats_timer -= frame_time;
+    if (stats_timer <= 0)
+    {
+        refreshWorldStats(world);
+        stats_timer = 0.25f;
+    }
+}
+
+void Profiler::refreshAggregates()
+{
+    float frame_sum = 0;
+    frame_min = frame_times[0];
+
+    sorted_scratch.clear();
+    for (int i = 0; i < frame_filled; i++)
+    {
+        frame_sum += frame_times[i];
+        frame_min = std::min(frame_min, frame_times[i]);
+        sorted_scratch.push_back(frame_times[i]);
+    }
+
+    frame_avg = frame_sum / frame_filled;
+
+    // Only the 99th percentile element needs to be in place, not the whole window sorted
+    int p99_index = std::min((int)(frame_filled * 0.99f), frame_filled - 1);
+    std::nth_element(sorted_scratch.begin(), sorted_scratch.begin() + p99_index, sorted_scratch.end());
+    frame_p99 = sorted_scratch[p99_index];
+
+    for (int s = 0; s < ProfileSlot_Count; s++)
+    {
+        float slot_sum = 0;
+        for (int i = 0; i < frame_filled; i++)
+            slot_sum += slot_times[s][i];
+
+        slot_avg[s] = slot_sum / frame_filled;
+    }
+}
+
+void Profiler::refreshWorldStats(flecs::world &world)
+{
+    ecs_world_stats_get(world.c_ptr(), &world_stats);
+
+    entity_count = (int)world_stats.entities.count.gauge.avg[world_stats.t];
+    table_count = (int)world_stats.tables.count.gauge.avg[world_stats.t];
+}
+
+void Profiler::draw(int x, int y)
+{
+    if (!visible)
+        return;
+
+    const int w = 300;
+    const int line_h = 14;
+    const int font_size = 10;
+    const int hist_h = 60;
+
+    int h = line_h * (ProfileSlot_Count + 5) + hist_h + 20;
+    DrawRectangle(x, y, w, h, Fade(BLACK, 0.75f));
+
+    int line_y = y + 6;
+    char line[128];
+
+    snprintf(line, sizeof(line), "frame ms  min %.2f  avg %.2f  p99 %.2f", frame_min, frame_avg, frame_p99);
+    DrawText(line, x + 6, line_y, font_size, WHITE);
+    line_y += line_h;
+
+    snprintf(line, sizeof(line), "entities %d  tables %d  (window %d frames)", entity_count, table_count, frame_filled);
+    DrawText(line, x + 6, line_y, font_size, LIGHTGRAY);
+    line_y += line_h + 4;
+
+    // Per-system CPU time, averaged over the window (summed over the threads of multi-threaded systems)
+    for (int i = 0; i < ProfileSlot_Count; i++)
+    {
+        snprintf(line, sizeof(line), "%-18s %7.3f ms", slot_names[i], slot_avg[i]);
+        DrawText(line, x + 6, line_y, font_size, i == ProfileSlot_Render ? SKYBLUE : GREEN);
+        line_y += line_h;
+    }
+
+    line_y += 6;
+
+    // Frame time histogram, oldest frame on the left, scaled to 33ms with a 60fps line
+    const float hist_max_ms = 1000.f / 30.f;
+    int hist_y = line_y + hist_h;
+    float bar_w = (float)(w - 12) / frame_times.size();
+
+    DrawRectangleLines(x + 6, line_y, w - 12, hist_h, DARKGRAY);
+
+    for (int i = 0; i < frame_filled; i++)
+    {
+        int index = (frame_head - frame_filled + i + frame_times.size()) % frame_times.size();
+        float ms = frame_times[index];
+        float bar_h = std::min(ms / hist_max_ms, 1.f) * hist_h;
+
+        Color bar_color = ms > 1000.f / 60.f + 1.f ? RED : LIME;
+        DrawRectangleV(Vector2{x + 6 + i * bar_w, hist_y - bar_h}, Vector2{std::max(bar_w, 1.f), bar_h}, bar_color);
+    }
+
+    float line_60_y = hist_y - (1000.f / 60.f) / hist_max_ms * hist_h;
+    DrawLineV(Vector2{(float)x + 6, line_60_y}, Vector2{(float)x + w - 6, line_60_y}, YELLOW);
+    line_y += hist_h + 4;
+
+    DrawText("F3 to hide", x + 6, line_y, font_size, GRAY);
+}
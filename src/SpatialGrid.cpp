@@ -0,0 +1,157 @@
+#include "SpatialGrid.hpp"
+
+SpatialGrid::SpatialGrid(float cell_size)
+{
+    this->cell_size = cell_size;
+}
+
+uint64_t SpatialGrid::cellKey(int cx, int cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+int SpatialGrid::toCell(float v) const
+{
+    return (int)std::floor(v / cell_size);
+}
+
+void SpatialGrid::addToCells(int body)
+{
+    GridBody &b = bodies[body];
+
+    for (int cx = b.min_cx; cx <= b.max_cx; cx++)
+        for (int cy = b.min_cy; cy <= b.max_cy; cy++)
+            cells[cellKey(cx, cy)].push_back(body);
+}
+
+void SpatialGrid::removeFromCells(int body)
+{
+    GridBody &b = bodies[body];
+
+    for (int cx = b.min_cx; cx <= b.max_cx; cx++)
+    {
+        for (int cy = b.min_cy; cy <= b.max_cy; cy++)
+        {
+            auto cell = cells.find(cellKey(cx, cy));
+            if (cell == cells.end())
+                continue;
+
+            // Order inside a cell doesn't matter, swap and pop
+            std::vector<int> &cell_bodies = cell->second;
+            for (int i = 0; i < cell_bodies.size(); i++)
+            {
+                if (cell_bodies[i] == body)
+                {
+                    cell_bodies[i] = cell_bodies.back();
+                    cell_bodies.pop_back();
+                    break;
+                }
+            }
+
+            if (cell_bodies.empty())
+                cells.erase(cell);
+        }
+    }
+}
+
+void SpatialGrid::insert(flecs::entity_t entity, c2AABB aabb)
+{
+    int min_cx = toCell(aabb.min.x);
+    int min_cy = toCell(aabb.min.y);
+    int max_cx = toCell(aabb.max.x);
+    int max_cy = toCell(aabb.max.y);
+
+    auto found = body_lookup.find(entity);
+
+    // Already in the grid: only re-bucket if it changed cells
+    if (found != body_lookup.end())
+    {
+        GridBody &b = bodies[found->second];
+        b.aabb = aabb;
+
+        if (b.min_cx == min_cx && b.min_cy == min_cy && b.max_cx == max_cx && b.max_cy == max_cy)
+            return;
+
+        removeFromCells(found->second);
+        b.min_cx = min_cx;
+        b.min_cy = min_cy;
+        b.max_cx = max_cx;
+        b.max_cy = max_cy;
+        addToCells(found->second);
+        return;
+    }
+
+    int body;
+    if (!free_bodies.empty())
+    {
+        body = free_bodies.back();
+        free_bodies.pop_back();
+    }
+    else
+    {
+        body = bodies.size();
+        bodies.push_back({});
+    }
+
+    bodies[body] = {entity, aabb, min_cx, min_cy, max_cx, max_cy};
+    body_lookup[entity] = body;
+    addToCells(body);
+}
+
+void SpatialGrid::remove(flecs::entity_t entity)
+{
+    auto found = body_lookup.find(entity);
+    if (found == body_lookup.end())
+        return;
+
+    removeFromCells(found->second);
+    free_bodies.push_back(found->second);
+    body_lookup.erase(found);
+}
+
+void SpatialGrid::clear()
+{
+    bodies.clear();
+    free_bodies.clear();
+    body_lookup.clear();
+    cells.clear();
+}
+
+void SpatialGrid::query(c2AABB box, std::vector<int> &out) const
+{
+    out.clear();
+
+    int min_cx = toCell(box.min.x);
+    int min_cy = toCell(box.min.y);
+    int max_cx = toCell(box.max.x);
+    int max_cy = toCell(box.max.y);
+
+    for (int cx = min_cx; cx <= max_cx; cx++)
+    {
+        for (int cy = min_cy; cy <= max_cy; cy++)
+        {
+            auto cell = cells.find(cellKey(cx, cy));
+            if (cell == cells.end())
+                continue;
+
+            out.insert(out.end(), cell->second.begin(), cell->second.end());
+        }
+    }
+
+    // Bodies spanning several cells show up more than once
+    if (min_cx != max_cx || min_cy != max_cy)
+    {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
+
+const c2AABB &SpatialGrid::getAABB(int body) const
+{
+    return bodies[body].aabb;
+}
+
+int SpatialGrid::getBodyCount() const
+{
+    return body_lookup.size();
+}
@@ -0,0 +1,223 @@
+#include "SpriteAtlas.hpp"
+
+SpriteAtlas::SpriteAtlas()
+{
+    packed_page_count = 0;
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+    for (auto &page : pages)
+        UnloadTexture(page);
+}
+
+bool SpriteAtlas::load(const char *path)
+{
+    if (!FileExists(path))
+        return false;
+
+    int data_size = 0;
+    uint8_t *data = LoadFileData(path, &data_size);
+
+    if (!data)
+        return false;
+
+    //--------------------------------------------------------------------------------------
+    // Validate the header and section bounds before trusting anything in the file
+    //--------------------------------------------------------------------------------------
+    if (data_size < (int)sizeof(plt::AtlasBinHeader))
+    {
+        TraceLog(LOG_WARNING, "ATLAS: %s is too small for an atlas header, using the separate textures", path);
+        UnloadFileData(data);
+        return false;
+    }
+
+    const plt::AtlasBinHeader *header = (const plt::AtlasBinHeader *)data;
+
+    auto section_fits = [&](uint32_t offset, uint64_t count, size_t elem_size)
+    {
+        return offset % 4 == 0 && offset + count * elem_size <= (size_t)data_size;
+    };
+
+    bool valid = header->magic == plt::AtlasBin_Magic &&
+                 header->version == plt::AtlasBin_Version &&
+                 header->file_size == data_size &&
+                 section_fits(header->page_offset, header->page_count, sizeof(plt::AtlasBinPage)) &&
+                 section_fits(header->source_offset, header->source_count, sizeof(plt::AtlasBinSource)) &&
+                 section_fits(header->cell_offset, header->cell_count, sizeof(plt::AtlasBinCell));
+
+    // The source and cell tables are only formed once the header is known to describe this file
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "ATLAS: %s is not a valid atlas (version %u expected), using the separate textures", path, plt::AtlasBin_Version);
+        UnloadFileData(data);
+        return false;
+    }
+
+    const plt::AtlasBinSource *bin_sources = (const plt::AtlasBinSource *)(data + header->source_offset);
+    const plt::AtlasBinCell *bin_cells = (const plt::AtlasBinCell *)(data + header->cell_offset);
+
+    for (uint32_t i = 0; valid && i < header->source_count; i++)
+    {
+        const plt::AtlasBinSource &src = bin_sources[i];
+        valid = src.cell_w > 0 && src.cell_h > 0 && src.columns >= 0 && src.rows >= 0 &&
+                src.first_cell + (uint64_t)src.columns * src.rows <= header->cell_count;
+    }
+
+    for (uint32_t i = 0; valid && i < header->cell_count; i++)
+        valid = bin_cells[i].page < (int)header->page_count;
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "ATLAS: %s has sources or cells outside its tables, using the separate textures", path);
+        UnloadFileData(data);
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Pages
+    //--------------------------------------------------------------------------------------
+    const plt::AtlasBinPage *bin_pages = (const plt::AtlasBinPage *)(data + header->page_offset);
+
+    for (uint32_t i = 0; i < header->page_count; i++)
+    {
+        std::string image(bin_pages[i].image, strnlen(bin_pages[i].image, sizeof(bin_pages[i].image)));
+
+        Image page_img = LoadImage(image.c_str());
+        pages.push_back(LoadTextureFromImage(page_img));
+        UnloadImage(page_img);
+    }
+
+    packed_page_count = pages.size();
+
+    //--------------------------------------------------------------------------------------
+    // Remap table
+    //--------------------------------------------------------------------------------------
+    for (uint32_t i = 0; i < header->source_count; i++)
+    {
+        const plt::AtlasBinSource &src = bin_sources[i];
+
+        Source source;
+        source.image = std::string(src.image, strnlen(src.image, sizeof(src.image)));
+        source.cell_w = src.cell_w;
+        source.cell_h = src.cell_h;
+        source.columns = src.columns;
+        source.rows = src.rows;
+        source.cells.assign(bin_cells + src.first_cell, bin_cells + src.first_cell + src.columns * src.rows);
+        source.fallback_page = -1;
+
+        sources.push_back(std::move(source));
+    }
+
+    UnloadFileData(data);
+
+    // Room for every source's fallback page, loading one later mustn't grow the page list mid-frame
+    pages.reserve(packed_page_count + sources.size());
+
+    // Sheets with cells the packer left out are drawn from their original image, load those now
+    for (auto &source : sources)
+    {
+        for (auto &cell : source.cells)
+        {
+            if (cell.page < 0)
+            {
+                getFallbackPage(source);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+int SpriteAtlas::getFallbackPage(Source &source)
+{
+    if (source.fallback_page < 0)
+    {
+        Image img = LoadImage(source.image.c_str());
+        pages.push_back(LoadTextureFromImage(img));
+        UnloadImage(img);
+
+        source.fallback_page = pages.size() - 1;
+    }
+
+    return source.fallback_page;
+}
+
+int SpriteAtlas::getSource(const std::string &image)
+{
+    for (int i = 0; i < sources.size(); i++)
+    {
+        if (sources[i].image == image)
+            return i;
+    }
+
+    // Not packed: the whole image is one cell, drawn straight from its own texture
+    if (packed_page_count > 0)
+        TraceLog(LOG_WARNING, "ATLAS: %s isn't in the atlas, re-run SpeedJam5_atlaspack", image.c_str());
+
+    Source source;
+    source.image = image;
+    source.columns = 1;
+    source.rows = 1;
+    source.cells.assign(1, plt::AtlasBinCell{-1, 0, 0, 0});
+    source.fallback_page = -1;
+
+    pages.reserve(packed_page_count + sources.size() + 1);
+
+    Texture2D tex = pages[getFallbackPage(source)];
+    source.cell_w = tex.width;
+    source.cell_h = tex.height;
+
+    sources.push_back(std::move(source));
+    return sources.size() - 1;
+}
+
+Vector2 SpriteAtlas::getSourceSize(int source) const
+{
+    const Source &s = sources[source];
+    return Vector2{(float)s.cell_w * s.columns, (float)s.cell_h * s.rows};
+}
+
+AtlasSprite SpriteAtlas::resolve(int source, Rectangle src)
+{
+    Source &s = sources[source];
+
+    float x = src.x;
+    float y = src.y;
+    float w = std::fabs(src.width);
+    float h = std::fabs(src.height);
+
+    int column = (int)std::floor(x / s.cell_w);
+    int row = (int)std::floor(y / s.cell_h);
+
+    // The rect has to lie within one packed cell, anything else comes from the original image
+    if (column >= 0 && column < s.columns && row >= 0 && row < s.rows &&
+        x + w <= (column + 1) * s.cell_w && y + h <= (row + 1) * s.cell_h)
+    {
+        const plt::AtlasBinCell &cell = s.cells[row * s.columns + column];
+
+        if (cell.page >= 0)
+        {
+            return AtlasSprite{pages[cell.page],
+                               Rectangle{cell.x + (x - column * s.cell_w), cell.y + (y - row * s.cell_h), src.width, src.height}};
+        }
+    }
+
+    return AtlasSprite{pages[getFallbackPage(s)], src};
+}
+
+Texture2D SpriteAtlas::getSourceTexture(int source)
+{
+    return pages[getFallbackPage(sources[source])];
+}
+
+int SpriteAtlas::getPageCount() const
+{
+    return packed_page_count;
+}
+
+int SpriteAtlas::getFallbackCount() const
+{
+    return pages.size() - packed_page_count;
+}
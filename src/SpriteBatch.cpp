@@ -0,0 +1,214 @@
+#include "SpriteBatch.hpp"
+#include "rlgl.h"
+
+// Quarter-pixel y resolution, 24 bits covers +-2 million pixels around 0
+static const float y_quantize_scale = 4.f;
+static const int y_quantize_bias = 1 << 23;
+static const int y_quantize_max = (1 << 24) - 1;
+
+// Quads per rlBegin/rlEnd, well under the smallest (web) default render batch
+static const int max_quads_per_submit = 512;
+
+static const int max_texture_slots = 256;
+
+SpriteBatch::SpriteBatch(int capacity)
+{
+    last_texture_slot = -1;
+    warned_slots_full = false;
+
+    textures.reserve(max_texture_slots);
+    reserve(capacity);
+}
+
+void SpriteBatch::reserve(int capacity)
+{
+    sprites.reserve(capacity);
+    keys.reserve(capacity);
+    keys_scratch.reserve(capacity);
+}
+
+void SpriteBatch::clear()
+{
+    sprites.clear();
+    keys.clear();
+
+    // Slots outlive frames, once they're used up start over so only textures still drawn take one
+    if (textures.size() >= max_texture_slots)
+    {
+        textures.clear();
+        last_texture_slot = -1;
+    }
+}
+
+int SpriteBatch::getTextureSlot(Texture2D tex)
+{
+    // Sprites usually come in streaks of the same texture
+    if (last_texture_slot >= 0 && textures[last_texture_slot].id == tex.id)
+        return last_texture_slot;
+
+    for (int i = 0; i < textures.size(); i++)
+    {
+        if (textures[i].id == tex.id)
+        {
+            textures[i] = tex;
+            last_texture_slot = i;
+            return i;
+        }
+    }
+
+    // The sort key has 8 bits for the slot
+    if (textures.size() >= max_texture_slots)
+        return -1;
+
+    textures.push_back(tex);
+    last_texture_slot = textures.size() - 1;
+    return last_texture_slot;
+}
+
+void SpriteBatch::add(Texture2D tex, Rectangle source, Vector2 position, Color color, float y_level)
+{
+    int slot = getTextureSlot(tex);
+
+    if (slot < 0)
+    {
+        if (!warned_slots_full)
+            TraceLog(LOG_WARNING, "SPRITEBATCH: more than %d textures in one frame, dropping sprites", max_texture_slots);
+
+        warned_slots_full = true;
+        return;
+    }
+
+    int y_quantized = (int)std::floor(y_level * y_quantize_scale) + y_quantize_bias;
+    y_quantized = std::max(0, std::min(y_quantized, y_quantize_max));
+
+    keys.push_back({((uint32_t)y_quantized << 8) | (uint32_t)slot, (uint32_t)sprites.size()});
+    sprites.push_back({source, position, color, slot});
+}
+
+void SpriteBatch::sort()
+{
+    int count = keys.size();
+    if (count < 2)
+        return;
+
+    keys_scratch.resize(count);
+
+    SpriteKey *src = keys.data();
+    SpriteKey *dst = keys_scratch.data();
+
+    // LSD radix sort, one byte of the key per pass; counting sort passes are stable
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        int offsets[256] = {};
+
+        for (int i = 0; i < count; i++)
+            offsets[(src[i].sort_key >> shift) & 0xFF]++;
+
+        // Every key shares this byte (common for the high y bits), nothing to reorder
+        if (offsets[(src[0].sort_key >> shift) & 0xFF] == count)
+            continue;
+
+        int total = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            int bucket_count = offsets[b];
+            offsets[b] = total;
+            total += bucket_count;
+        }
+
+        for (int i = 0; i < count; i++)
+            dst[offsets[(src[i].sort_key >> shift) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    // Depending on how many passes were skipped the result may have ended up in the scratch buffer
+    if (src != keys.data())
+        keys.swap(keys_scratch);
+}
+
+void SpriteBatch::drawRun(int texture_slot, const SpriteKey *run_keys, int count)
+{
+    const Texture2D &tex = textures[texture_slot];
+    float inv_w = 1.f / tex.width;
+    float inv_h = 1.f / tex.height;
+
+    for (int start = 0; start < count; start += max_quads_per_submit)
+    {
+        int end = std::min(start + max_quads_per_submit, count);
+
+        // Flush rlgl's batch up front if this submit wouldn't fit
+        rlCheckRenderBatchLimit((end - start) * 4);
+
+        rlSetTexture(tex.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.f, 0.f, 1.f);
+
+        for (int i = start; i < end; i++)
+        {
+            const Sprite &spr = sprites[run_keys[i].sprite];
+
+            // Same corners and winding as DrawTexturePro. A negative source size flips the same
+            // rect (x to x + |width|), so its texture coordinates are swapped, not mirrored around x
+            float src_w = std::fabs(spr.source.width);
+            float src_h = std::fabs(spr.source.height);
+
+            float x0 = spr.position.x;
+            float y0 = spr.position.y;
+            float x1 = x0 + src_w;
+            float y1 = y0 + src_h;
+
+            float u0 = spr.source.x * inv_w;
+            float v0 = spr.source.y * inv_h;
+            float u1 = (spr.source.x + src_w) * inv_w;
+            float v1 = (spr.source.y + src_h) * inv_h;
+
+            if (spr.source.width < 0)
+                std::swap(u0, u1);
+            if (spr.source.height < 0)
+                std::swap(v0, v1);
+
+            rlColor4ub(spr.color.r, spr.color.g, spr.color.b, spr.color.a);
+
+            rlTexCoord2f(u0, v0);
+            rlVertex2f(x0, y0);
+
+            rlTexCoord2f(u0, v1);
+            rlVertex2f(x0, y1);
+
+            rlTexCoord2f(u1, v1);
+            rlVertex2f(x1, y1);
+
+            rlTexCoord2f(u1, v0);
+            rlVertex2f(x1, y0);
+        }
+
+        rlEnd();
+        rlSetTexture(0);
+    }
+}
+
+void SpriteBatch::draw()
+{
+    sort();
+
+    int count = keys.size();
+    int run_start = 0;
+
+    // Submit each run of consecutive same-texture sprites together
+    for (int i = 1; i <= count; i++)
+    {
+        int run_slot = keys[run_start].sort_key & 0xFF;
+
+        if (i == count || (int)(keys[i].sort_key & 0xFF) != run_slot)
+        {
+            drawRun(run_slot, &keys[run_start], i - run_start);
+            run_start = i;
+        }
+    }
+}
+
+int SpriteBatch::getSpriteCount() const
+{
+    return sprites.size();
+}
@@ -0,0 +1,102 @@
+#include "Trace.hpp"
+
+#ifdef PLT_TRACE
+
+typedef std::chrono::steady_clock TraceClock;
+
+static const TraceClock::time_point trace_epoch = TraceClock::now();
+
+// Every thread's buffer, owned here so zones survive their thread until the next flush
+static std::mutex trace_buffers_mutex;
+static std::vector<std::unique_ptr<TraceBuffer>> trace_buffers;
+
+static thread_local TraceBuffer *thread_buffer = nullptr;
+
+// Only taken once per thread, the first time it records a zone (or names itself)
+static TraceBuffer *registerThreadBuffer()
+{
+    std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+
+    trace_buffers.push_back(std::make_unique<TraceBuffer>());
+    TraceBuffer *buffer = trace_buffers.back().get();
+
+    buffer->thread_index = trace_buffers.size() - 1;
+    buffer->thread_name = "worker";
+    buffer->head.store(0, std::memory_order_relaxed);
+
+    return buffer;
+}
+
+uint64_t traceNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(TraceClock::now() - trace_epoch).count();
+}
+
+void traceSetThreadName(const char *name)
+{
+    if (!thread_buffer)
+        thread_buffer = registerThreadBuffer();
+
+    // Flushes read the name under the lock
+    std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+    thread_buffer->thread_name = name;
+}
+
+void traceRecord(const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+    if (!thread_buffer)
+        thread_buffer = registerThreadBuffer();
+
+    uint64_t head = thread_buffer->head.load(std::memory_order_relaxed);
+    thread_buffer->events[head % TraceBuffer::capacity] = {name, start_ns, end_ns - start_ns};
+
+    // Publish the event to flushes on other threads
+    thread_buffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool traceFlush(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        printf("trace: can't open %s\n", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    size_t event_count = 0;
+
+    for (auto &buffer : trace_buffers)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",\n", buffer->thread_index, buffer->thread_name, buffer->thread_index);
+        first = false;
+
+        // A thread still recording can lap the oldest slots while they're written out; flush
+        // between frames to keep the snapshot consistent
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > TraceBuffer::capacity ? head - TraceBuffer::capacity : 0;
+
+        for (uint64_t i = begin; i < head; i++)
+        {
+            const TraceEvent &ev = buffer->events[i % TraceBuffer::capacity];
+
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"speedjam5\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    ev.name, buffer->thread_index, ev.start_ns / 1000.0, ev.duration_ns / 1000.0);
+        }
+
+        event_count += head - begin;
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("trace: wrote %zu zones to %s\n", event_count, path);
+    return true;
+}
+
+#endif
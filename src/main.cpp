@@ -1,18 +1,5 @@
 #include "main.hpp"
 
-// Immediate-mode GUI Library
-#define RAYGUI_IMPLEMENTATION
-#define GLSL_VERSION 330
-#include "raygui.h"
-
-// Tiled loader
-#define CUTE_TILED_IMPLEMENTATION
-#include "cute_tiled.h"
-
-// Collision
-#define CUTE_C2_IMPLEMENTATION
-#include "cute_c2.hpp"
-
 std::unique_ptr<App> main_app;
 
 void updateAndDraw()
@@ -20,33 +7,230 @@ void updateAndDraw()
     main_app->runFrame();
 }
 
-int main(void)
+int runHeadless(int screen_w, int screen_h, int sim_hz, int ticks, uint64_t seed, int threads, const char *record_path)
+{
+    App app(screen_w, screen_h, sim_hz, true, seed);
+
+    if (threads > 1)
+        app.setThreadCount(threads);
+
+    if (record_path)
+        app.startRecording();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int tick = 0; tick < ticks; tick++)
+        app.stepHeadless(App::getScriptedInput(tick, sim_hz));
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("headless: %d ticks in %.3f s (%.0f ticks/s, %.1fx realtime)\n", ticks, elapsed.count(), ticks / elapsed.count(), ticks / (double)sim_hz / elapsed.count());
+    printf("headless: game state %d, speedrun time %.2f, %d customers left\n", (int)app.getGameState(), app.getTimeCounter(), app.getCustomerCount());
+
+    if (record_path && !app.saveRecording(record_path))
+        return 1;
+
+    return 0;
+}
+
+// Feed a recorded input log back through a headless App as fast as it will go
+int runReplay(int screen_w, int screen_h, int threads, const char *replay_path)
+{
+    InputLog log(0, 0);
+    if (!log.load(replay_path))
+        return 1;
+
+    printf("replay: %d ticks at %d Hz, seed %llu\n", log.getTickCount(), log.getSimHz(), (unsigned long long)log.getSeed());
+
+    App app(screen_w, screen_h, log.getSimHz(), true, log.getSeed());
+
+    if (threads > 1)
+        app.setThreadCount(threads);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    int ticks = 0;
+    plt::InputState input;
+
+    while (log.nextInput(input))
+    {
+        app.stepHeadless(input);
+        ticks++;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("replay: %d ticks in %.3f s (%.0f ticks/s, %.1fx realtime)\n", ticks, elapsed.count(), ticks / elapsed.count(), ticks / (double)log.getSimHz() / elapsed.count());
+    printf("replay: game state %d, speedrun time %.2f, %d customers left\n", (int)app.getGameState(), app.getTimeCounter(), app.getCustomerCount());
+
+    return 0;
+}
+
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
+    // Workers can record zones before this thread does, so it names itself instead of being the first one seen
+    TRACE_THREAD_NAME("main");
+
     const int screen_w = 640;
     const int screen_h = 384;
 
-    srand(time(NULL));
+    // Command line
+    //      --headless      Run the simulation only, no window or GPU
+    //      --ticks <n>     Number of simulation ticks to run when headless
+    //      --trace <file>  Write the recorded trace zones to file on exit (non-release builds, F4 dumps mid-run)
+    //      --seed <n>      Seed for every random draw (orders, customers), a seed replays a run exactly
+    //      --record <file> Write every tick's input and the seed to file on exit
+    //      --replay <file> Run a recorded input log headless at full speed and print where it ended up
+    //      --sim-hz <n>    Simulation ticks per second, independent of the render rate (default 60, replays use the log's)
+    //      --threads <n>   Split the multi-threaded simulation systems over n threads (default 1)
+    //
+    // Native only (the browser drives the web build's frame rate):
+    //      --uncapped      Don't limit the frame rate
+    //      --vsync         Wait for vertical sync
+    //      --no-vsync      Don't wait for vertical sync (default)
+    //      --frames <n>    Quit after n frames and print frame timings
+    //      --map-shader    Draw the tilemap with the tile index shader instead of baked chunks
+    bool headless = false;
+    int sim_hz = 60;
+
+    // Ten simulated minutes unless --ticks is given
+    int headless_ticks = -1;
+    const char *trace_path = nullptr;
+    uint64_t seed = (uint64_t)time(NULL);
+    const char *record_path = nullptr;
+    const char *replay_path = nullptr;
+
+    bool uncapped = false;
+    bool vsync = false;
+    int max_frames = 0;
+    int threads = 1;
+    bool map_shader = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            headless_ticks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_path = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc)
+            sim_hz = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--uncapped") == 0)
+            uncapped = true;
+        else if (strcmp(argv[i], "--vsync") == 0)
+            vsync = true;
+        else if (strcmp(argv[i], "--no-vsync") == 0)
+            vsync = false;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            max_frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--map-shader") == 0)
+            map_shader = true;
+        else
+            printf("Unknown option: %s\n", argv[i]);
+    }
+
+    if (sim_hz < App_MinSimHz || sim_hz > App_MaxSimHz)
+    {
+        printf("--sim-hz must be between %d and %d\n", App_MinSimHz, App_MaxSimHz);
+        return 1;
+    }
+
+    if (headless_ticks < 0)
+        headless_ticks = sim_hz * 60 * 10;
+
+    if (replay_path)
+    {
+        int result = runReplay(screen_w, screen_h, threads, replay_path);
+
+        if (trace_path)
+            TRACE_FLUSH(trace_path);
+
+        return result;
+    }
+
+    printf("seed: %llu\n", (unsigned long long)seed);
+
+    if (headless)
+    {
+        int result = runHeadless(screen_w, screen_h, sim_hz, headless_ticks, seed, threads, record_path);
+
+        if (trace_path)
+            TRACE_FLUSH(trace_path);
+
+        return result;
+    }
 
     // Set antialiasing
     // SetConfigFlags(FLAG_MSAA_4X_HINT);
 
+    if (vsync)
+        SetConfigFlags(FLAG_VSYNC_HINT);
+
     // Init window and framerate
     InitWindow(screen_w, screen_h, "SpeedJam5");
 
-    // Set target FPS
-    SetTargetFPS(60);
+    // Set target FPS (0 leaves it unlimited)
+    SetTargetFPS(uncapped ? 0 : 60);
 
     // Initialize the main App
-    main_app = std::make_unique<App>(screen_w, screen_h);
+    main_app = std::make_unique<App>(screen_w, screen_h, sim_hz, false, seed);
+
+    if (record_path)
+        main_app->startRecording();
 
+#ifndef __EMSCRIPTEN__
+    if (threads > 1)
+        main_app->setThreadCount(threads);
+
+    if (map_shader && !main_app->setMapRenderMode(MapRenderMode_Shader))
+        printf("map: tile shader unavailable, using baked chunks\n");
+#endif
+
+#ifdef __EMSCRIPTEN__
     // Set the emscripten main loop
     emscripten_set_main_loop(updateAndDraw, 0, 1);
-    //-------------------------------------------------------------------------------------- 
- 
+#else
+    // Native main loop, the baseline for profiling
+    int frame_count = 0;
+    double loop_start = GetTime();
+
+    while (!WindowShouldClose() && (max_frames == 0 || frame_count < max_frames))
+    {
+        updateAndDraw();
+        frame_count++;
+    }
+
+    double loop_time = GetTime() - loop_start;
+    if (frame_count > 0)
+        printf("native: %d frames in %.3f s (%.3f ms/frame, %.1f fps)\n", frame_count, loop_time, loop_time * 1000.0 / frame_count, frame_count / loop_time);
+
+    if (record_path)
+    {
+        printf("native: speedrun time %.2f\n", main_app->getTimeCounter());
+        main_app->saveRecording(record_path);
+    }
+
+    if (trace_path)
+        TRACE_FLUSH(trace_path);
+#endif
+    //--------------------------------------------------------------------------------------
+
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    // The App unloads its music, textures, render targets and shaders, the contexts must still exist
+    main_app.reset();
+
     CloseAudioDevice();
     CloseWindow();
     //--------------------------------------------------------------------------------------
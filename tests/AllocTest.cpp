@@ -0,0 +1,172 @@
+// Render allocation test: once warmed up, drawing a frame must not touch the heap (see App::RenderSystem)
+//
+// Allocations are only counted in Debug builds (PLT_COUNT_ALLOCS), run it through ctest from one:
+//      cmake .. -DCMAKE_BUILD_TYPE=Debug && cmake --build . && ctest --output-on-failure
+//
+// Exits 0 if no counted frame allocated, 1 otherwise, 77 (skipped) without the counter or a window.
+// Scenes that stay on one view never reach the growth paths, so both scenes here keep changing:
+//  - Map streaming: panning over the whole map bakes new chunks (render targets, tile buckets)
+//    and queues different front tiles every frame
+//  - A running day: chefs keep spawning until the sprite batch is well past its initial capacity
+
+#include "main.hpp"
+
+static const int test_screen_w = 640;
+static const int test_screen_h = 384;
+static const int test_sim_hz = 60;
+static const uint64_t test_seed = 1;
+
+// Frames drawn before counting (trace buffers, rlgl batch, first bakes)
+static const int warmup_frames = 3;
+
+// Reaches into App's private state (App declares it as a friend)
+struct AppAllocTest
+{
+    static void startDay(App &app)
+    {
+        app.game_state = plt::GameState_Day1;
+        app.prev_game_state = plt::GameState_Day1;
+    }
+
+    static void addChefs(App &app, int count, std::mt19937 &gen)
+    {
+        std::uniform_real_distribution<float> x_dist(0, test_screen_w);
+        std::uniform_real_distribution<float> y_dist(0, test_screen_h);
+
+        for (int i = 0; i < count; i++)
+        {
+            plt::Position pos = {x_dist(gen), y_dist(gen), 0};
+
+            flecs::entity e = app.ecs_world->entity();
+            e.set<plt::Position>(pos);
+            e.set<plt::PrevPosition>({pos.x, pos.y});
+            e.set<plt::Player>({false, plt::PlayerMvnmtState_Forward, 0, 0.1, 0.3, 0, plt::PlayerHoldingType_None, plt::CookingZone_None});
+        }
+    }
+
+    // One frame of the render pipeline, returns the allocations made inside its counted region
+    static uint64_t renderFrame(App &app)
+    {
+        app.RenderSystem();
+        return app.render_frame_allocs;
+    }
+
+    static int getSpriteCount(App &app)
+    {
+        return app.sprite_batch->getSpriteCount();
+    }
+};
+
+static int failures = 0;
+
+static void check(const char *scene, int frame, uint64_t allocs)
+{
+    if (allocs == 0)
+        return;
+
+    fprintf(stderr, "%s: frame %d made %llu heap allocations\n", scene, frame, (unsigned long long)allocs);
+    failures++;
+}
+
+// ==================================================
+// Map::draw + Map::queueFront + SpriteBatch::draw, panning over the whole map
+// ==================================================
+static void testMapStreaming()
+{
+    SpriteAtlas atlas;
+    atlas.load("atlas.bin");
+
+    flecs::world world;
+    Map map(&world, false, &atlas);
+
+    // Sized like App::RenderSystem does it, from the front tile count
+    SpriteBatch batch(map.getFrontTileCount());
+
+    Rectangle bounds = map.getBounds();
+    const float pan_step = 48.f;
+
+    int frame = 0;
+    for (float y = 0; y < bounds.height; y += test_screen_h / 2.f)
+    {
+        for (float x = 0; x < bounds.width; x += pan_step, frame++)
+        {
+            Rectangle view = {x, y, (float)test_screen_w, (float)test_screen_h};
+
+            BeginDrawing();
+
+            uint64_t allocs_before = getAllocCount();
+
+            map.draw(view);
+            batch.clear();
+            map.queueFront(batch, view);
+            batch.draw();
+
+            uint64_t allocs = getAllocCount() - allocs_before;
+
+            EndDrawing();
+
+            if (frame >= warmup_frames)
+                check("map_streaming", frame, allocs);
+        }
+    }
+
+    fprintf(stderr, "map_streaming: %d frames, %d of %d chunks baked, %d separate textures\n",
+            frame, map.getBakedChunkCount(), map.getChunkCount(), atlas.getFallbackCount());
+}
+
+// ==================================================
+// App::RenderSystem during a day, with the chef count growing past the batch's initial capacity
+// ==================================================
+static void testDayRender()
+{
+    App app(test_screen_w, test_screen_h, test_sim_hz, false, test_seed);
+    AppAllocTest::startDay(app);
+
+    std::mt19937 gen(1);
+
+    int frame = 0;
+    for (; frame < warmup_frames; frame++)
+        AppAllocTest::renderFrame(app);
+
+    // 64 more chefs every frame, up to about 4x the batch's initial 1024 sprites
+    for (int step = 0; step < 64; step++, frame++)
+    {
+        AppAllocTest::addChefs(app, 64, gen);
+        check("day_render", frame, AppAllocTest::renderFrame(app));
+    }
+
+    fprintf(stderr, "day_render: %d frames, %d sprites in the last one\n", frame, AppAllocTest::getSpriteCount(app));
+}
+
+int main(int argc, char **argv)
+{
+#ifndef PLT_COUNT_ALLOCS
+    fprintf(stderr, "Allocations aren't counted in this build (Debug only), skipping\n");
+    return 77;
+#endif
+
+    // A hidden window gives the chunk bakes and sprite draws a GL context
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(test_screen_w, test_screen_h, "SpeedJam5_alloctest");
+
+    if (!IsWindowReady())
+    {
+        fprintf(stderr, "No window available, skipping\n");
+        return 77;
+    }
+
+    testMapStreaming();
+    testDayRender();
+
+    CloseWindow();
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d frames allocated\n", failures);
+        return 1;
+    }
+
+    fprintf(stderr, "No frame allocated\n");
+    return 0;
+}
@@ -0,0 +1,488 @@
+// Offline atlas packer: sprite sheets + the map's used tiles -> atlas pages and a remap table (see AtlasFormat.hpp)
+//
+// Usage:
+//      SpeedJam5_atlaspack <assets dir> <map.bin | map.json>
+//
+// Give it the map the game loads: a baked map already has its tilesets stripped to a compact one.
+// Writes atlas.bin and atlas0.png, atlas1.png, ... into the assets directory.
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+
+// Image loading/saving
+#include "raylib.h"
+
+// Tiled loader
+#define CUTE_TILED_IMPLEMENTATION
+#include "cute_tiled.h"
+
+#include "MapFormat.hpp"
+#include "AtlasFormat.hpp"
+#include "FoodCatalog.hpp"
+
+// A sprite sheet and the cells of it the game draws
+struct PackSource
+{
+    std::string image;
+
+    // Decoded RGBA8 pixels
+    std::vector<uint32_t> pixels;
+    int width;
+    int height;
+
+    int cell_w;
+    int cell_h;
+    int columns;
+    int rows;
+
+    std::vector<bool> wanted;
+    std::vector<plt::AtlasBinCell> cells;
+};
+
+// A cell waiting for a spot on a page
+struct PackItem
+{
+    int source;
+    int cell;
+    int w;
+    int h;
+};
+
+// The map's tilesets and every GID its tile layers use
+struct MapTiles
+{
+    int tile_w;
+    int tile_h;
+    std::vector<plt::MapBinTileset> tilesets;
+    std::vector<int32_t> gids;
+};
+
+static std::string assets_dir;
+
+static bool loadBakedMapTiles(const char *path, MapTiles &tiles)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + read);
+    fclose(file);
+
+    // Nothing in the header can be read before the size is known to cover it
+    if (data.size() < sizeof(plt::MapBinHeader))
+        return false;
+
+    const plt::MapBinHeader *header = (const plt::MapBinHeader *)data.data();
+
+    auto section_fits = [&](uint32_t offset, uint64_t count, size_t elem_size)
+    {
+        return offset % 4 == 0 && offset + count * elem_size <= data.size();
+    };
+
+    if (header->magic != plt::MapBin_Magic || header->version != plt::MapBin_Version ||
+        header->map_w <= 0 || header->map_h <= 0 || header->tile_w <= 0 || header->tile_h <= 0 ||
+        !section_fits(header->tileset_offset, header->tileset_count, sizeof(plt::MapBinTileset)) ||
+        !section_fits(header->layer_offset, header->layer_count, sizeof(plt::MapBinLayer)))
+        return false;
+
+    tiles.tile_w = header->tile_w;
+    tiles.tile_h = header->tile_h;
+
+    const plt::MapBinTileset *bin_tilesets = (const plt::MapBinTileset *)(data.data() + header->tileset_offset);
+    tiles.tilesets.assign(bin_tilesets, bin_tilesets + header->tileset_count);
+
+    const plt::MapBinLayer *bin_layers = (const plt::MapBinLayer *)(data.data() + header->layer_offset);
+    uint64_t layer_tiles = (uint64_t)header->map_w * header->map_h;
+
+    for (uint32_t i = 0; i < header->layer_count; i++)
+    {
+        if (!section_fits(bin_layers[i].data_offset, layer_tiles, sizeof(int32_t)))
+            return false;
+
+        const int32_t *gids = (const int32_t *)(data.data() + bin_layers[i].data_offset);
+        tiles.gids.insert(tiles.gids.end(), gids, gids + layer_tiles);
+    }
+
+    return true;
+}
+
+static bool loadTiledMapTiles(const char *path, MapTiles &tiles)
+{
+    cute_tiled_map_t *map = cute_tiled_load_map_from_file(path, NULL);
+    if (!map)
+        return false;
+
+    tiles.tile_w = map->tilewidth;
+    tiles.tile_h = map->tileheight;
+
+    for (cute_tiled_tileset_t *ts_ptr = map->tilesets; ts_ptr; ts_ptr = ts_ptr->next)
+    {
+        plt::MapBinTileset ts = {};
+        ts.firstgid = ts_ptr->firstgid;
+        ts.tilecount = ts_ptr->tilecount;
+        ts.columns = ts_ptr->columns;
+        snprintf(ts.image, sizeof(ts.image), "%s", std::filesystem::path(ts_ptr->image.ptr).filename().string().c_str());
+
+        tiles.tilesets.push_back(ts);
+    }
+
+    for (cute_tiled_layer_t *layer = map->layers; layer; layer = layer->next)
+    {
+        if (strcmp("tilelayer", layer->type.ptr) == 0)
+            tiles.gids.insert(tiles.gids.end(), layer->data, layer->data + layer->data_count);
+    }
+
+    cute_tiled_free_map(map);
+    return true;
+}
+
+static bool loadSource(PackSource &source, const std::string &image, int cell_w, int cell_h)
+{
+    std::string path = (std::filesystem::path(assets_dir) / image).string();
+
+    Image img = LoadImage(path.c_str());
+    if (!img.data)
+    {
+        fprintf(stderr, "Failed to load %s\n", path.c_str());
+        return false;
+    }
+
+    ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    source.image = image;
+    source.width = img.width;
+    source.height = img.height;
+    source.pixels.assign((uint32_t *)img.data, (uint32_t *)img.data + img.width * img.height);
+    UnloadImage(img);
+
+    // A cell size of 0 makes the whole image a single cell
+    source.cell_w = cell_w > 0 ? cell_w : source.width;
+    source.cell_h = cell_h > 0 ? cell_h : source.height;
+    source.columns = source.width / source.cell_w;
+    source.rows = source.height / source.cell_h;
+
+    source.wanted.assign(source.columns * source.rows, false);
+    source.cells.assign(source.columns * source.rows, plt::AtlasBinCell{-1, 0, 0, 0});
+
+    return true;
+}
+
+static bool isCellEmpty(const PackSource &source, int cell)
+{
+    int x0 = (cell % source.columns) * source.cell_w;
+    int y0 = (cell / source.columns) * source.cell_h;
+
+    for (int y = y0; y < y0 + source.cell_h; y++)
+    {
+        for (int x = x0; x < x0 + source.cell_w; x++)
+        {
+            if (source.pixels[y * source.width + x] & 0xFF000000)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Mark the cell holding a pixel position (as the game's source rects give it)
+static void wantCellAt(PackSource &source, float x, float y)
+{
+    int column = (int)x / source.cell_w;
+    int row = (int)y / source.cell_h;
+
+    if (column >= 0 && column < source.columns && row >= 0 && row < source.rows)
+        source.wanted[row * source.columns + column] = true;
+}
+
+static void wantNonEmptyCells(PackSource &source)
+{
+    for (int cell = 0; cell < source.columns * source.rows; cell++)
+        source.wanted[cell] = !isCellEmpty(source, cell);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <assets dir> <map.bin | map.json>\n", argv[0]);
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    assets_dir = argv[1];
+
+    std::vector<PackSource> sources;
+
+    //--------------------------------------------------------------------------------------
+    // Sprite sheets drawn whole (every non-empty cell)
+    //--------------------------------------------------------------------------------------
+    struct SheetDef
+    {
+        const char *image;
+        int cell_w;
+        int cell_h;
+    };
+
+    const SheetDef sheets[] = {
+        {"chef_ghost_strip.png", 32, 32},
+        {"customers.png", 32, 32},
+        {"Fire 64x.png", 64, 64},
+        {"Am_I_cooked.png", 0, 0},
+        {"not_cooked.png", 0, 0},
+    };
+
+    for (auto &sheet : sheets)
+    {
+        PackSource source;
+        if (!loadSource(source, sheet.image, sheet.cell_w, sheet.cell_h))
+            return 1;
+
+        wantNonEmptyCells(source);
+        sources.push_back(std::move(source));
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Food: only the catalog's cells, every state row of each ingredient
+    //--------------------------------------------------------------------------------------
+    {
+        PackSource source;
+        if (!loadSource(source, plt::FoodCatalog_Image, plt::FoodCatalog_Cell, plt::FoodCatalog_Cell))
+            return 1;
+
+        for (auto &def : plt::ingredient_defs)
+        {
+            for (int state = 0; state < plt::FoodCatalog_StateRows; state++)
+                wantCellAt(source, def.x, def.y + state * plt::FoodCatalog_Cell);
+        }
+
+        for (auto &def : plt::dish_defs)
+            wantCellAt(source, def.x, def.y);
+
+        for (auto &cell : plt::bowl_fill_cells)
+            wantCellAt(source, cell.x, cell.y);
+
+        sources.push_back(std::move(source));
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Map tilesets: only the tiles the tile layers use
+    //--------------------------------------------------------------------------------------
+    MapTiles map_tiles;
+    bool map_loaded = std::filesystem::path(argv[2]).extension() == ".bin" ? loadBakedMapTiles(argv[2], map_tiles)
+                                                                          : loadTiledMapTiles(argv[2], map_tiles);
+    if (!map_loaded)
+    {
+        fprintf(stderr, "Failed to load the map %s\n", argv[2]);
+        return 1;
+    }
+
+    for (auto &ts : map_tiles.tilesets)
+    {
+        PackSource source;
+        if (!loadSource(source, std::string(ts.image, strnlen(ts.image, sizeof(ts.image))), map_tiles.tile_w, map_tiles.tile_h))
+            return 1;
+
+        for (int32_t gid : map_tiles.gids)
+        {
+            int local_id = cute_tiled_unset_flags(gid) - ts.firstgid;
+
+            if (local_id >= 0 && local_id < ts.tilecount && local_id < source.wanted.size())
+                source.wanted[local_id] = true;
+        }
+
+        sources.push_back(std::move(source));
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Shelf-pack the wanted cells, tallest first, opening a new page when one fills up
+    //--------------------------------------------------------------------------------------
+    std::vector<PackItem> items;
+    size_t source_bytes = 0;
+
+    for (int s = 0; s < sources.size(); s++)
+    {
+        source_bytes += sources[s].pixels.size() * 4;
+
+        for (int cell = 0; cell < sources[s].wanted.size(); cell++)
+        {
+            if (sources[s].wanted[cell])
+                items.push_back({s, cell, sources[s].cell_w + 2 * plt::AtlasBin_Padding, sources[s].cell_h + 2 * plt::AtlasBin_Padding});
+        }
+    }
+
+    std::stable_sort(items.begin(), items.end(), [](const PackItem &a, const PackItem &b)
+                     { return a.h != b.h ? a.h > b.h : a.w > b.w; });
+
+    struct PackPage
+    {
+        int width;
+        int height;
+        int shelf_x;
+        int shelf_y;
+        int shelf_h;
+    };
+
+    std::vector<PackPage> pages;
+
+    for (auto &item : items)
+    {
+        if (item.w > plt::AtlasBin_MaxPageSize || item.h > plt::AtlasBin_MaxPageSize)
+        {
+            fprintf(stderr, "%s: cells of %dx%d don't fit a page\n", sources[item.source].image.c_str(), item.w, item.h);
+            return 1;
+        }
+
+        // Only the newest page has room, earlier ones were closed when they filled up
+        if (!pages.empty())
+        {
+            PackPage &page = pages.back();
+
+            if (page.shelf_x + item.w > plt::AtlasBin_MaxPageSize)
+            {
+                page.shelf_y += page.shelf_h;
+                page.shelf_x = 0;
+                page.shelf_h = 0;
+            }
+
+            if (page.shelf_y + item.h > plt::AtlasBin_MaxPageSize)
+                pages.push_back({0, 0, 0, 0, 0});
+        }
+        else
+        {
+            pages.push_back({0, 0, 0, 0, 0});
+        }
+
+        PackPage &page = pages.back();
+
+        plt::AtlasBinCell &cell = sources[item.source].cells[item.cell];
+        cell.page = (int16_t)(pages.size() - 1);
+        cell.x = (uint16_t)(page.shelf_x + plt::AtlasBin_Padding);
+        cell.y = (uint16_t)(page.shelf_y + plt::AtlasBin_Padding);
+
+        page.shelf_x += item.w;
+        page.shelf_h = std::max(page.shelf_h, item.h);
+        page.width = std::max(page.width, page.shelf_x);
+        page.height = std::max(page.height, page.shelf_y + page.shelf_h);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Copy the cells onto the pages, extruding their edges into the padding
+    //--------------------------------------------------------------------------------------
+    std::vector<std::vector<uint32_t>> page_pixels(pages.size());
+    for (int p = 0; p < pages.size(); p++)
+        page_pixels[p].assign(pages[p].width * pages[p].height, 0);
+
+    for (auto &item : items)
+    {
+        const PackSource &source = sources[item.source];
+        const plt::AtlasBinCell &cell = source.cells[item.cell];
+
+        std::vector<uint32_t> &dst = page_pixels[cell.page];
+        int dst_w = pages[cell.page].width;
+
+        int src_x = (item.cell % source.columns) * source.cell_w;
+        int src_y = (item.cell / source.columns) * source.cell_h;
+
+        for (int y = -plt::AtlasBin_Padding; y < source.cell_h + plt::AtlasBin_Padding; y++)
+        {
+            int sy = src_y + std::clamp(y, 0, source.cell_h - 1);
+
+            for (int x = -plt::AtlasBin_Padding; x < source.cell_w + plt::AtlasBin_Padding; x++)
+            {
+                int sx = src_x + std::clamp(x, 0, source.cell_w - 1);
+                dst[(cell.y + y) * dst_w + cell.x + x] = source.pixels[sy * source.width + sx];
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Write the pages and the remap table
+    //--------------------------------------------------------------------------------------
+    std::vector<plt::AtlasBinPage> bin_pages;
+    std::vector<plt::AtlasBinSource> bin_sources;
+    std::vector<plt::AtlasBinCell> bin_cells;
+    size_t page_bytes = 0;
+
+    for (int p = 0; p < pages.size(); p++)
+    {
+        plt::AtlasBinPage bin_page = {};
+        bin_page.width = pages[p].width;
+        bin_page.height = pages[p].height;
+        snprintf(bin_page.image, sizeof(bin_page.image), "atlas%d.png", p);
+
+        Image page_img = {page_pixels[p].data(), pages[p].width, pages[p].height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        std::string path = (std::filesystem::path(assets_dir) / bin_page.image).string();
+
+        if (!ExportImage(page_img, path.c_str()))
+        {
+            fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return 1;
+        }
+
+        page_bytes += page_pixels[p].size() * 4;
+        bin_pages.push_back(bin_page);
+    }
+
+    for (auto &source : sources)
+    {
+        plt::AtlasBinSource bin_source = {};
+        bin_source.cell_w = source.cell_w;
+        bin_source.cell_h = source.cell_h;
+        bin_source.columns = source.columns;
+        bin_source.rows = source.rows;
+        bin_source.first_cell = (uint32_t)bin_cells.size();
+
+        if (source.image.size() >= sizeof(bin_source.image))
+        {
+            fprintf(stderr, "Image name too long: %s\n", source.image.c_str());
+            return 1;
+        }
+        strcpy(bin_source.image, source.image.c_str());
+
+        bin_sources.push_back(bin_source);
+        bin_cells.insert(bin_cells.end(), source.cells.begin(), source.cells.end());
+    }
+
+    plt::AtlasBinHeader header = {};
+    header.magic = plt::AtlasBin_Magic;
+    header.version = plt::AtlasBin_Version;
+    header.page_count = (uint32_t)bin_pages.size();
+    header.source_count = (uint32_t)bin_sources.size();
+    header.cell_count = (uint32_t)bin_cells.size();
+
+    // Every struct is a multiple of 4 bytes, so the sections stay aligned back to back
+    header.page_offset = sizeof(header);
+    header.source_offset = header.page_offset + (uint32_t)(bin_pages.size() * sizeof(plt::AtlasBinPage));
+    header.cell_offset = header.source_offset + (uint32_t)(bin_sources.size() * sizeof(plt::AtlasBinSource));
+    header.file_size = header.cell_offset + (uint32_t)(bin_cells.size() * sizeof(plt::AtlasBinCell));
+
+    std::string bin_path = (std::filesystem::path(assets_dir) / "atlas.bin").string();
+    FILE *file = fopen(bin_path.c_str(), "wb");
+
+    bool written = file &&
+                   fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(bin_pages.data(), sizeof(plt::AtlasBinPage), bin_pages.size(), file) == bin_pages.size() &&
+                   fwrite(bin_sources.data(), sizeof(plt::AtlasBinSource), bin_sources.size(), file) == bin_sources.size() &&
+                   fwrite(bin_cells.data(), sizeof(plt::AtlasBinCell), bin_cells.size(), file) == bin_cells.size();
+
+    if (file)
+        fclose(file);
+
+    if (!written)
+    {
+        fprintf(stderr, "Failed to write %s\n", bin_path.c_str());
+        return 1;
+    }
+
+    printf("Packed %zu cells from %zu images into %zu page(s): %zu KB of textures instead of %zu KB\n",
+           items.size(), sources.size(), pages.size(), page_bytes / 1024, source_bytes / 1024);
+
+    return 0;
+}
@@ -0,0 +1,427 @@
+// Offline map converter: Tiled JSON export -> baked binary map (see MapFormat.hpp)
+//
+// Usage:
+//      SpeedJam5_mapbake [--no-strip] <map.json> <map.bin>
+//
+// The tiles the layers use are copied into one compact tileset next to the baked map
+// (<map>_tiles.png) and the layers' GIDs are rewritten to point into it, so the game never
+// uploads the unused parts of the original tilesets. Tiles that don't fit one 2048 x 2048 page
+// spill into <map>_tiles1.png, <map>_tiles2.png, ... --no-strip keeps the original tilesets.
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+// Image loading/saving
+#include "raylib.h"
+
+// Tiled loader
+#define CUTE_TILED_IMPLEMENTATION
+#include "cute_tiled.h"
+
+#include "MapFormat.hpp"
+
+// Appends raw bytes, keeping every section 4-byte aligned
+static uint32_t appendBytes(std::vector<uint8_t> &out, const void *data, size_t size)
+{
+    while (out.size() % 4 != 0)
+        out.push_back(0);
+
+    uint32_t offset = (uint32_t)out.size();
+    const uint8_t *bytes = (const uint8_t *)data;
+    out.insert(out.end(), bytes, bytes + size);
+
+    return offset;
+}
+
+// Biggest compact tileset page, safe for WebGL 1 devices
+static const int max_tileset_size = 2048;
+
+// Copy every used tile into one compact tileset and rewrite the layers' GIDs to point into it.
+// Identical tiles are merged and fully transparent ones become empty (GID 0)
+static bool stripTilesets(const cute_tiled_map_t *map, const std::string &map_dir, const std::filesystem::path &tiles_path,
+                          std::vector<plt::MapBinTileset> &tilesets, std::vector<std::vector<int32_t>> &layer_data)
+{
+    int tile_w = map->tilewidth;
+    int tile_h = map->tileheight;
+    int tile_pixels = tile_w * tile_h;
+
+    //--------------------------------------------------------------------------------------
+    // Decode the original tilesets
+    //--------------------------------------------------------------------------------------
+    struct TilesetPixels
+    {
+        std::vector<uint32_t> pixels;
+        int width;
+        int height;
+    };
+
+    std::vector<TilesetPixels> sources(tilesets.size());
+    size_t original_bytes = 0;
+
+    for (int ts = 0; ts < tilesets.size(); ts++)
+    {
+        std::string path = (std::filesystem::path(map_dir) / tilesets[ts].image).string();
+
+        Image img = LoadImage(path.c_str());
+        if (!img.data)
+        {
+            fprintf(stderr, "Failed to load tileset %s\n", path.c_str());
+            return false;
+        }
+
+        ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        sources[ts].width = img.width;
+        sources[ts].height = img.height;
+        sources[ts].pixels.assign((uint32_t *)img.data, (uint32_t *)img.data + img.width * img.height);
+        UnloadImage(img);
+
+        // The game uploads every tileset whole
+        original_bytes += sources[ts].pixels.size() * sizeof(uint32_t);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Collect the used tiles, giving each distinct one a new local id
+    //--------------------------------------------------------------------------------------
+    std::unordered_map<int, int> new_gids;
+    std::unordered_map<std::string, int> tile_ids;
+    std::vector<std::string> tiles;
+
+    int used_count = 0;
+
+    for (auto &data : layer_data)
+    {
+        for (auto &gid : data)
+        {
+            int tile_data = cute_tiled_unset_flags(gid);
+            if (tile_data <= 0)
+                continue;
+
+            auto found = new_gids.find(tile_data);
+            if (found == new_gids.end())
+            {
+                used_count++;
+
+                // Find the tileset owning this GID
+                int owner = -1;
+                for (int ts = 0; ts < tilesets.size(); ts++)
+                {
+                    if (tile_data >= tilesets[ts].firstgid && tile_data < tilesets[ts].firstgid + tilesets[ts].tilecount)
+                        owner = ts;
+                }
+
+                int new_gid = 0;
+
+                if (owner >= 0)
+                {
+                    const TilesetPixels &src = sources[owner];
+                    int local_id = tile_data - tilesets[owner].firstgid;
+                    int x0 = (local_id % tilesets[owner].columns) * tile_w;
+                    int y0 = (local_id / tilesets[owner].columns) * tile_h;
+
+                    std::string tile(tile_pixels * sizeof(uint32_t), '\0');
+                    uint32_t *tile_px = (uint32_t *)tile.data();
+                    bool transparent = true;
+
+                    for (int y = 0; y < tile_h; y++)
+                    {
+                        for (int x = 0; x < tile_w; x++)
+                        {
+                            uint32_t px = 0;
+                            if (x0 + x < src.width && y0 + y < src.height)
+                                px = src.pixels[(y0 + y) * src.width + x0 + x];
+
+                            tile_px[y * tile_w + x] = px;
+                            transparent = transparent && (px & 0xFF000000) == 0;
+                        }
+                    }
+
+                    if (!transparent)
+                    {
+                        auto existing = tile_ids.find(tile);
+                        if (existing == tile_ids.end())
+                        {
+                            existing = tile_ids.emplace(tile, (int)tiles.size()).first;
+                            tiles.push_back(tile);
+                        }
+
+                        new_gid = existing->second + 1;
+                    }
+                }
+
+                found = new_gids.emplace(tile_data, new_gid).first;
+            }
+
+            // Keep the flip flags, the rest of the GID is the new tile
+            gid = found->second ? (int32_t)(((uint32_t)gid & ~(uint32_t)tile_data) | (uint32_t)found->second) : 0;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Write the compact tileset, one page per 2048 x 2048 worth of tiles.
+    // New GIDs are consecutive, so each page is a tileset starting where the last one ended
+    //--------------------------------------------------------------------------------------
+    int tile_count = tiles.size();
+    int max_columns = max_tileset_size / tile_w;
+    int max_rows = max_tileset_size / tile_h;
+
+    if (max_columns < 1 || max_rows < 1)
+    {
+        fprintf(stderr, "Tiles of %d x %d don't fit a %d x %d tileset page\n", tile_w, tile_h, max_tileset_size, max_tileset_size);
+        return false;
+    }
+
+    int page_tiles = max_columns * max_rows;
+    int page_count = std::max((tile_count + page_tiles - 1) / page_tiles, 1);
+
+    int original_count = 0;
+    for (auto &ts : tilesets)
+        original_count += ts.tilecount;
+
+    std::vector<plt::MapBinTileset> compact_tilesets;
+    size_t compact_bytes = 0;
+
+    for (int page = 0; page < page_count; page++)
+    {
+        int first_tile = page * page_tiles;
+        int count = std::min(tile_count - first_tile, page_tiles);
+
+        // A single page stays roughly square, spilled pages are full width
+        int columns = page_count == 1 ? std::max(std::min((int)std::ceil(std::sqrt((double)count)), max_columns), 1) : max_columns;
+        int rows = std::max((count + columns - 1) / columns, 1);
+
+        std::vector<uint32_t> pixels((size_t)columns * tile_w * rows * tile_h, 0);
+        int width = columns * tile_w;
+
+        for (int t = 0; t < count; t++)
+        {
+            const uint32_t *tile_px = (const uint32_t *)tiles[first_tile + t].data();
+            int x0 = (t % columns) * tile_w;
+            int y0 = (t / columns) * tile_h;
+
+            for (int y = 0; y < tile_h; y++)
+                memcpy(&pixels[(size_t)(y0 + y) * width + x0], &tile_px[y * tile_w], tile_w * sizeof(uint32_t));
+        }
+
+        std::filesystem::path page_path = tiles_path;
+        if (page > 0)
+            page_path.replace_filename(tiles_path.stem().string() + std::to_string(page) + tiles_path.extension().string());
+
+        Image tiles_img = {pixels.data(), width, rows * tile_h, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        if (!ExportImage(tiles_img, page_path.string().c_str()))
+        {
+            fprintf(stderr, "Failed to write %s\n", page_path.string().c_str());
+            return false;
+        }
+
+        plt::MapBinTileset compact = {};
+        compact.firstgid = first_tile + 1;
+        compact.tilecount = count;
+        compact.columns = columns;
+
+        std::string image = page_path.filename().string();
+        if (image.size() >= sizeof(compact.image))
+        {
+            fprintf(stderr, "Tileset image name too long: %s\n", image.c_str());
+            return false;
+        }
+        strcpy(compact.image, image.c_str());
+
+        compact_tilesets.push_back(compact);
+        compact_bytes += pixels.size() * sizeof(uint32_t);
+
+        printf("Tileset page %s: %d tiles (%d x %d)\n", image.c_str(), count, width, rows * tile_h);
+    }
+
+    tilesets = compact_tilesets;
+
+    printf("Stripped tilesets: %d of %d tiles used, %d distinct in %d page(s)\n",
+           used_count, original_count, tile_count, page_count);
+    printf("Tileset texture memory: %zu KB -> %zu KB (%zu KB saved)\n",
+           original_bytes / 1024, compact_bytes / 1024, (original_bytes - std::min(original_bytes, compact_bytes)) / 1024);
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool strip = true;
+    int arg = 1;
+
+    if (argc == 4 && strcmp(argv[1], "--no-strip") == 0)
+    {
+        strip = false;
+        arg = 2;
+    }
+
+    if (argc - arg != 2)
+    {
+        fprintf(stderr, "Usage: %s [--no-strip] <map.json> <map.bin>\n", argv[0]);
+        return 1;
+    }
+
+    const char *json_path = argv[arg];
+    const char *bin_path = argv[arg + 1];
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    cute_tiled_map_t *map = cute_tiled_load_map_from_file(json_path, NULL);
+    if (!map)
+    {
+        fprintf(stderr, "Failed to parse %s: %s\n", json_path, cute_tiled_error_reason);
+        return 1;
+    }
+
+    std::vector<plt::MapBinTileset> tilesets;
+    std::vector<const cute_tiled_layer_t *> tile_layers;
+    std::vector<plt::MapBinRect> colliders;
+    std::vector<plt::MapBinObject> objects;
+
+    //--------------------------------------------------------------------------------------
+    // Tilesets (only the image's file name is kept, assets are flattened at runtime)
+    //--------------------------------------------------------------------------------------
+    for (cute_tiled_tileset_t *ts_ptr = map->tilesets; ts_ptr; ts_ptr = ts_ptr->next)
+    {
+        plt::MapBinTileset ts = {};
+        ts.firstgid = ts_ptr->firstgid;
+        ts.tilecount = ts_ptr->tilecount;
+        ts.columns = ts_ptr->columns;
+
+        std::string image = std::filesystem::path(ts_ptr->image.ptr).filename().string();
+        if (image.size() >= sizeof(ts.image))
+        {
+            fprintf(stderr, "Tileset image name too long: %s\n", image.c_str());
+            return 1;
+        }
+        strcpy(ts.image, image.c_str());
+
+        tilesets.push_back(ts);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Layers, collision rects and typed objects
+    //--------------------------------------------------------------------------------------
+    for (cute_tiled_layer_t *layer = map->layers; layer; layer = layer->next)
+    {
+        if (strcmp("tilelayer", layer->type.ptr) == 0)
+        {
+            if (layer->data_count != map->width * map->height)
+            {
+                fprintf(stderr, "Layer %s has %d tiles, expected %d\n", layer->name.ptr, layer->data_count, map->width * map->height);
+                return 1;
+            }
+
+            tile_layers.push_back(layer);
+        }
+        else if (strcmp("objectgroup", layer->type.ptr) == 0)
+        {
+            if (strcmp("Collision", layer->name.ptr) == 0)
+            {
+                for (cute_tiled_object_t *obj = layer->objects; obj; obj = obj->next)
+                    colliders.push_back({obj->x, obj->y, obj->width, obj->height});
+            }
+            else if (strcmp("Objects", layer->name.ptr) == 0)
+            {
+                for (cute_tiled_object_t *obj = layer->objects; obj; obj = obj->next)
+                {
+                    plt::MapObjectKind kind = plt::mapObjectKindFromName(obj->name.ptr);
+
+                    if (kind == plt::MapObject_None)
+                    {
+                        fprintf(stderr, "Skipping unknown object '%s'\n", obj->name.ptr);
+                        continue;
+                    }
+
+                    objects.push_back({kind, {obj->x, obj->y, obj->width, obj->height}});
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Strip the tilesets down to the used tiles
+    //--------------------------------------------------------------------------------------
+    std::vector<std::vector<int32_t>> layer_data;
+    for (auto *layer : tile_layers)
+        layer_data.emplace_back(layer->data, layer->data + layer->data_count);
+
+    if (strip)
+    {
+        std::filesystem::path tiles_path = std::filesystem::path(bin_path);
+        tiles_path.replace_filename(tiles_path.stem().string() + "_tiles.png");
+
+        if (!stripTilesets(map, std::filesystem::path(json_path).parent_path().string(), tiles_path, tilesets, layer_data))
+            return 1;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Write out the file
+    //--------------------------------------------------------------------------------------
+    std::vector<uint8_t> out;
+
+    plt::MapBinHeader header = {};
+    header.magic = plt::MapBin_Magic;
+    header.version = plt::MapBin_Version;
+    header.map_w = map->width;
+    header.map_h = map->height;
+    header.tile_w = map->tilewidth;
+    header.tile_h = map->tileheight;
+    header.tileset_count = (uint32_t)tilesets.size();
+    header.layer_count = (uint32_t)tile_layers.size();
+    header.collider_count = (uint32_t)colliders.size();
+    header.object_count = (uint32_t)objects.size();
+
+    // Header is patched once every offset is known
+    appendBytes(out, &header, sizeof(header));
+
+    header.tileset_offset = appendBytes(out, tilesets.data(), tilesets.size() * sizeof(plt::MapBinTileset));
+
+    std::vector<plt::MapBinLayer> layers(tile_layers.size());
+    header.layer_offset = appendBytes(out, layers.data(), layers.size() * sizeof(plt::MapBinLayer));
+    header.collider_offset = appendBytes(out, colliders.data(), colliders.size() * sizeof(plt::MapBinRect));
+    header.object_offset = appendBytes(out, objects.data(), objects.size() * sizeof(plt::MapBinObject));
+
+    for (int i = 0; i < tile_layers.size(); i++)
+    {
+        const cute_tiled_layer_t *layer = tile_layers[i];
+
+        layers[i].flags = 0;
+        if (layer->class_.ptr && strcmp("frontlayer", layer->class_.ptr) == 0)
+            layers[i].flags |= plt::MapBinLayer_Front;
+
+        layers[i].data_offset = appendBytes(out, layer_data[i].data(), layer_data[i].size() * sizeof(int32_t));
+    }
+
+    header.file_size = (uint32_t)out.size();
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + header.layer_offset, layers.data(), layers.size() * sizeof(plt::MapBinLayer));
+
+    FILE *file = fopen(bin_path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", bin_path);
+        return 1;
+    }
+
+    // fclose flushes the tail of the file, so it can fail too
+    bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    written = fclose(file) == 0 && written;
+
+    if (!written)
+    {
+        fprintf(stderr, "Failed to write %s\n", bin_path);
+        return 1;
+    }
+
+    printf("Baked %s -> %s (%d x %d, %u tilesets, %u layers, %u colliders, %u objects, %zu bytes)\n",
+           json_path, bin_path, header.map_w, header.map_h, header.tileset_count, header.layer_count,
+           header.collider_count, header.object_count, out.size());
+
+    cute_tiled_free_map(map);
+    return 0;
+}